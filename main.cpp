@@ -1,11 +1,60 @@
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <barrier>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <compare>
 #include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// USDT probes on the sequencer hot paths for bpftrace or perf, compiled in with -DSEQUENCER_USDT
+// (needs sys/sdt.h, e.g. from systemtap-sdt-dev). A probe that nothing is attached to is a single
+// nop. The first argument is always the sequencer instance:
+//   combiner_acquire(sequencer)            a thread took the combiner role
+//   combine_round(sequencer, batch_size)   a combiner or server served one batch
+//   waiter_released(sequencer, spins)      a waiter was served by someone else
+//   lease_refill(sequencer, lease_size)    a lease was taken from the shared counter
+//   cas_retry(sequencer)                   a CAS on a shared line failed and is retried
+// e.g. bpftrace -e 'usdt:./main:sequencer:combine_round { @batch = lhist(arg1, 0, 64, 1); }'
+#ifdef SEQUENCER_USDT
+#include <sys/sdt.h>
+#define SEQUENCER_PROBE1(name, arg1) DTRACE_PROBE1(sequencer, name, arg1)
+#define SEQUENCER_PROBE2(name, arg1, arg2) DTRACE_PROBE2(sequencer, name, arg1, arg2)
+#else
+#define SEQUENCER_PROBE1(name, arg1) static_cast<void>(0)
+#define SEQUENCER_PROBE2(name, arg1, arg2) static_cast<void>(0)
+#endif
+
 namespace {
 
 const size_t NUM_THREADS = 16;
@@ -16,12 +65,431 @@ const size_t COUNT_PER_THREAD = 10000000;
 
 uint64_t TOTAL_OPERATIONS = COUNT_PER_THREAD * NUM_THREADS;
 
+void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Spin-wait step for threads waiting on another thread. Yields the CPU every spins_before_yield
+// iterations so that an oversubscribed machine still makes progress, or on every iteration with
+// yield_while_waiting. Both may only be changed while no sequencer is in use (see
+// applySequencerConfig).
+const size_t SPINS_BEFORE_YIELD = 128;
+size_t spins_before_yield = SPINS_BEFORE_YIELD;
+bool yield_while_waiting = false;
+
+// Cycle counter for budgets and timing loops. Falls back to steady_clock nanoseconds on
+// architectures without a user-readable counter.
+uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t cycles;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(cycles));
+    return cycles;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+// Fenced cycle counter reads around a timed loop: the start read waits for all earlier
+// instructions and keeps later ones from starting early, the end read waits for the timed ones.
+uint64_t readCyclesStart() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_lfence();
+    uint64_t cycles = __builtin_ia32_rdtsc();
+    __builtin_ia32_lfence();
+    return cycles;
+#elif defined(__aarch64__)
+    asm volatile("isb" ::: "memory");
+    return readCycles();
+#else
+    return readCycles();
+#endif
+}
+
+uint64_t readCyclesEnd() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int aux;
+    uint64_t cycles = __builtin_ia32_rdtscp(&aux);
+    __builtin_ia32_lfence();
+    return cycles;
+#elif defined(__aarch64__)
+    asm volatile("isb" ::: "memory");
+    return readCycles();
+#else
+    return readCycles();
+#endif
+}
+
+// Deadlines for the tryGetAndIncrement family, either in wall-clock time or in cycles (cheaper to
+// check in tight spin loops).
+struct TimeDeadline {
+    std::chrono::steady_clock::time_point end;
+
+    bool expired() const {
+        return std::chrono::steady_clock::now() >= end;
+    }
+};
+
+struct CycleDeadline {
+    uint64_t end;
+
+    bool expired() const {
+        return readCycles() >= end;
+    }
+};
+
+TimeDeadline deadlineAfter(std::chrono::nanoseconds timeout) {
+    return TimeDeadline{std::chrono::steady_clock::now() + timeout};
+}
+
+CycleDeadline deadlineAfterCycles(uint64_t cycles) {
+    return CycleDeadline{readCycles() + cycles};
+}
+
+const size_t CACHE_LINE_SIZE = 64;
+
+// Cache-line-isolated copy of a sequencer's counter, published by the thread that advances it
+// after every batch. Monitoring reads of it give a lower bound of the counter without pulling the
+// line that requesters increment. Needs a single writer at a time (e.g. the combiner).
+class PublishedHighWater {
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> value{0};
+
+   public:
+    void publish(uint64_t high_water) {
+        value.store(high_water, std::memory_order_relaxed);
+    }
+
+    uint64_t read() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+// Hands out the per-thread slots (my_id) of a sequencer to threads that come and go. A thread
+// acquires a slot before its first call and releases it once it is done; it must not release it
+// while a call is in progress.
+template <size_t NUMBER>
+class SlotRegistry {
+    static_assert(NUMBER > 0 && NUMBER <= 64);
+    static constexpr uint64_t ALL_SLOTS = ~uint64_t{0} >> (64 - NUMBER);
+
+    std::atomic<uint64_t> used{0};
+
+   public:
+    // The lowest free slot, or nullopt if all of them are taken.
+    std::optional<size_t> acquire() {
+        uint64_t current = used.load();
+        while (current != ALL_SLOTS) {
+            size_t slot = std::countr_one(current);
+            if (used.compare_exchange_weak(current, current | (uint64_t{1} << slot))) {
+                return slot;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void release(size_t slot) {
+        used.fetch_and(~(uint64_t{1} << slot));
+    }
+
+    size_t inUse() const {
+        return std::popcount(used.load());
+    }
+};
+
+// Per-thread sequencer stats, compiled in with -DSEQUENCER_STATS for './main stats'. They cost a
+// thread_local lookup and a few stores per operation, which the numbers of all other modes must not
+// include; without them every stats() snapshot stays 0.
+#ifdef SEQUENCER_STATS
+const bool STATS_ENABLED = true;
+#else
+const bool STATS_ENABLED = false;
+#endif
+
+const size_t STATS_SLOTS = 64;
+
+// Threads own a stats line while they live; the lines are handed out like sequencer slots.
+SlotRegistry<STATS_SLOTS>& statsSlotRegistry() {
+    static SlotRegistry<STATS_SLOTS> registry;
+    return registry;
+}
+
+struct StatsSlotOwner {
+    std::optional<size_t> slot = statsSlotRegistry().acquire();
+
+    ~StatsSlotOwner() {
+        if (slot) {
+            statsSlotRegistry().release(*slot);
+        }
+    }
+};
+
+// The calling thread's stats line, or STATS_SLOTS, the shared line, once all are taken.
+size_t statsSlot() {
+    thread_local StatsSlotOwner owner;
+    return owner.slot.value_or(STATS_SLOTS);
+}
+
+enum class Stat : size_t {
+    OPERATIONS,
+    SHARED_RMWS,
+    COMBINING_ROUNDS,
+    COMBINED_OPERATIONS,
+    SPINS,
+    LEASE_REFILLS,
+    FALLBACKS,
+    COUNT
+};
+
+// Snapshot returned by the stats() of a sequencer. Counters a sequencer has no use for stay 0.
+struct SequencerStats {
+    uint64_t operations = 0;
+    // read-modify-writes on lines shared between threads, including failed CAS attempts
+    uint64_t shared_rmws = 0;
+    uint64_t combining_rounds = 0;
+    // numbers handed out by combining rounds, in total
+    uint64_t combined_operations = 0;
+    // iterations of wait loops
+    uint64_t spins = 0;
+    uint64_t lease_refills = 0;
+    // requests that left the fast path: lost races, expired deadlines, dropped leases
+    uint64_t fallbacks = 0;
+
+    SequencerStats& operator+=(const SequencerStats& other) {
+        operations += other.operations;
+        shared_rmws += other.shared_rmws;
+        combining_rounds += other.combining_rounds;
+        combined_operations += other.combined_operations;
+        spins += other.spins;
+        lease_refills += other.lease_refills;
+        fallbacks += other.fallbacks;
+        return *this;
+    }
+
+    double meanBatchSize() const {
+        return combining_rounds == 0 ? 0
+                                     : static_cast<double>(combined_operations) /
+                                           static_cast<double>(combining_rounds);
+    }
+};
+
+// COUNTERS counters kept per thread. Each thread adds to its own cache line without a
+// read-modify-write; sum() adds up the lines and may miss the latest additions.
+template <size_t COUNTERS>
+class PerThreadCounters {
+    struct alignas(CACHE_LINE_SIZE) Line {
+        std::array<std::atomic<uint64_t>, COUNTERS> values{};
+    };
+
+    std::array<Line, STATS_SLOTS + 1> lines;
+
+   public:
+    void add(size_t counter_i, uint64_t value) {
+        size_t slot = statsSlot();
+        auto& counter = lines[slot].values[counter_i];
+        if (slot == STATS_SLOTS) {
+            counter.fetch_add(value, std::memory_order_relaxed);
+        } else {
+            counter.store(counter.load(std::memory_order_relaxed) + value,
+                          std::memory_order_relaxed);
+        }
+    }
+
+    std::array<uint64_t, COUNTERS> sum() const {
+        std::array<uint64_t, COUNTERS> totals{};
+        for (const auto& line : lines) {
+            for (size_t counter_i = 0; counter_i < COUNTERS; counter_i++) {
+                totals[counter_i] += line.values[counter_i].load(std::memory_order_relaxed);
+            }
+        }
+        return totals;
+    }
+};
+
+// Per-thread statistics of one sequencer, a no-op unless STATS_ENABLED.
+class StatsCounters {
+    PerThreadCounters<static_cast<size_t>(Stat::COUNT)> counters;
+
+   public:
+    void add(Stat stat, uint64_t value = 1) {
+        if constexpr (STATS_ENABLED) {
+            counters.add(static_cast<size_t>(stat), value);
+        }
+    }
+
+    SequencerStats read() const {
+        auto totals = counters.sum();
+        return SequencerStats{totals[0], totals[1], totals[2], totals[3],
+                              totals[4], totals[5], totals[6]};
+    }
+};
+
+// cpuRelax iterations of all threads in wait loops, for the CPU accounting of the cases if
+// STATS_ENABLED. They are counted rather than timed, since a timed interval would include any time
+// the thread was preempted; yields are not counted at all.
+PerThreadCounters<1> wait_relaxes;
+
+// cpuRelax for wait loops, including a combiner's idle polls for further requests.
+void waitRelax() {
+    cpuRelax();
+    if constexpr (STATS_ENABLED) {
+        wait_relaxes.add(0, 1);
+    }
+}
+
+void spinWait(size_t& spins) {
+    if (yield_while_waiting || ++spins % spins_before_yield == 0) {
+        std::this_thread::yield();
+    } else {
+        waitRelax();
+    }
+}
+
+// Operations completed by the main cases, for the timeline sampler. The case loops report every
+// COMPLETED_BATCH-th operation with countCompleted(i) to keep the counting off the hot path.
+PerThreadCounters<1> completed_operations;
+
+const uint64_t COMPLETED_BATCH = 1024;
+
+void countCompleted(uint64_t i) {
+    if ((i + 1) % COMPLETED_BATCH == 0) {
+        completed_operations.add(0, COMPLETED_BATCH);
+    }
+}
+
+uint64_t completedOperations() {
+    return completed_operations.sum()[0];
+}
+
+// Fault injection for './main preempt': with the given probability, a thread inside a critical
+// section (the lock holder, or a combiner between taking a batch and handing out its numbers)
+// sleeps or yields, as if the kernel had descheduled it there. May only be changed while no
+// sequencer is in use.
+struct PreemptionInjection {
+    // in [0, 1], as std::bernoulli_distribution requires
+    double probability = 0;
+    std::chrono::microseconds duration{0};
+    bool yield = false;
+};
+
+PreemptionInjection preemption_injection;
+std::atomic<uint64_t> injected_preemptions{0};
+
+void maybePreempt() {
+    if (preemption_injection.probability == 0) {
+        return;
+    }
+    thread_local std::mt19937_64 random(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    if (!std::bernoulli_distribution(preemption_injection.probability)(random)) {
+        return;
+    }
+    injected_preemptions.fetch_add(1, std::memory_order_relaxed);
+    if (preemption_injection.yield) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(preemption_injection.duration);
+    }
+}
+
+uint64_t waitRelaxes() {
+    return wait_relaxes.sum()[0];
+}
+
+const size_t RELAX_CALIBRATION_ITERATIONS = 100000;
+
+// Time of one waitRelax on this machine, measured once on the calling thread.
+std::chrono::duration<double> waitRelaxTime() {
+    static std::chrono::duration<double> relax_time = []() {
+        auto start_time = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < RELAX_CALIBRATION_ITERATIONS; i++) {
+            waitRelax();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time) /
+               RELAX_CALIBRATION_ITERATIONS;
+    }();
+    return relax_time;
+}
+
+// CPU time of all threads of the process, including threads that have exited.
+std::chrono::nanoseconds processCpuTime() {
+#ifdef __linux__
+    timespec time;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::duration<double>(static_cast<double>(std::clock()) / CLOCKS_PER_SEC));
+#endif
+}
+
+// CPU time of the calling thread.
+std::chrono::nanoseconds threadCpuTime() {
+#ifdef __linux__
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#else
+    // wall-clock time, which also counts time spent blocked
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+#endif
+}
+
+// CPU time of all threads in contended mutex acquisitions, if STATS_ENABLED: spinning inside the
+// mutex and the futex calls around blocking. Time spent blocked is not CPU time.
+PerThreadCounters<1> lock_wait_nanoseconds;
+
+// Locks a mutex or unique_lock. Only an acquisition that fails try_lock reads the thread's CPU
+// clock, so uncontended acquisitions stay cheap.
+template <typename Lockable>
+void lockCounted(Lockable& lockable) {
+    if constexpr (STATS_ENABLED) {
+        if (lockable.try_lock()) {
+            return;
+        }
+        auto start = threadCpuTime();
+        lockable.lock();
+        lock_wait_nanoseconds.add(0, (threadCpuTime() - start).count());
+    } else {
+        lockable.lock();
+    }
+}
+
+std::chrono::duration<double> lockWaitTime() {
+    return std::chrono::nanoseconds(lock_wait_nanoseconds.sum()[0]);
+}
+
 std::atomic<uint64_t> counter_simple{0};
+StatsCounters stats_simple;
 
 uint64_t getAndIncrementCas() {
+    stats_simple.add(Stat::OPERATIONS);
+    stats_simple.add(Stat::SHARED_RMWS);
     return counter_simple++;
 }
 
+SequencerStats statsCas() {
+    return stats_simple.read();
+}
+
+// The next number to be issued; every number issued so far is below it.
+uint64_t currentCas() {
+    return counter_simple.load();
+}
+
+// fetch_add is wait-free, so there is nothing to give up on
+template <typename Deadline>
+std::optional<uint64_t> tryGetAndIncrementCas(const Deadline&) {
+    return getAndIncrementCas();
+}
+
 std::chrono::milliseconds caseSimple() {
     std::vector<std::thread> threads;
     threads.reserve(NUM_THREADS);
@@ -36,6 +504,7 @@ std::chrono::milliseconds caseSimple() {
             uint64_t my_total = 0;
             for (uint64_t i = 0; i < COUNT_PER_THREAD; ++i) {
                 my_total += getAndIncrementCas();
+                countCompleted(i);
             }
             total += my_total;
         });
@@ -64,9 +533,44 @@ std::chrono::milliseconds caseSimple() {
 
 std::atomic<uint64_t> counter_lock{0};
 
+std::mutex mutex_lock;
+StatsCounters stats_lock;
+
+// Acquiring the mutex counts as the shared read-modify-write.
 uint64_t getAndIncrementLock() {
-    static std::mutex mutex;
-    std::lock_guard guard(mutex);
+    stats_lock.add(Stat::OPERATIONS);
+    stats_lock.add(Stat::SHARED_RMWS);
+    lockCounted(mutex_lock);
+    std::lock_guard guard(mutex_lock, std::adopt_lock);
+    maybePreempt();
+    return counter_lock++;
+}
+
+SequencerStats statsLock() {
+    return stats_lock.read();
+}
+
+// Reads the counter without taking the lock, it is atomic for exactly this reason.
+uint64_t currentLock() {
+    return counter_lock.load();
+}
+
+template <typename Deadline>
+std::optional<uint64_t> tryGetAndIncrementLock(const Deadline& deadline) {
+    stats_lock.add(Stat::OPERATIONS);
+    stats_lock.add(Stat::SHARED_RMWS);
+    std::unique_lock guard(mutex_lock, std::try_to_lock);
+    size_t spins = 0;
+    while (!guard.owns_lock()) {
+        if (deadline.expired()) {
+            stats_lock.add(Stat::FALLBACKS);
+            return std::nullopt;
+        }
+        stats_lock.add(Stat::SPINS);
+        spinWait(spins);
+        stats_lock.add(Stat::SHARED_RMWS);
+        guard.try_lock();
+    }
     return counter_lock++;
 }
 
@@ -84,6 +588,7 @@ std::chrono::milliseconds caseLock() {
             uint64_t my_total = 0;
             for (uint64_t i = 0; i < COUNT_PER_THREAD; ++i) {
                 my_total += getAndIncrementLock();
+                countCompleted(i);
             }
             total += my_total;
         });
@@ -118,6 +623,36 @@ class Combiner {
     std::atomic<uint32_t> queued;
     std::mutex lock;
     std::array<std::atomic<uint64_t>, NUMBER> sequence_numbers;
+    PublishedHighWater high_water;
+    StatsCounters stats_counters;
+
+    // Fetches the batch from the shared counter and hands out numbers to the interested threads.
+    // Must be called with the lock held.
+    uint64_t distribute(size_t my_id, uint64_t numbers_needed_total) {
+        maybePreempt();
+        SEQUENCER_PROBE2(combine_round, this, numbers_needed_total);
+        stats_counters.add(Stat::COMBINING_ROUNDS);
+        stats_counters.add(Stat::COMBINED_OPERATIONS, numbers_needed_total);
+        stats_counters.add(Stat::SHARED_RMWS);
+        uint64_t distribute_range_lower = counter_combiner.fetch_add(numbers_needed_total);
+        uint64_t distribute_range_upper = distribute_range_lower + numbers_needed_total;
+        high_water.publish(distribute_range_upper);
+
+        uint64_t my_sequence_number = distribute_range_lower;
+
+        uint64_t current_number_to_distribute = my_sequence_number + 1;
+        for (size_t i = 0; i < NUMBER && current_number_to_distribute < distribute_range_upper;
+             i++) {
+            if (i != my_id && interested[i]) {
+                // publish the number before clearing the flag, a withdrawing tryGetAndIncrement
+                // reads it without the lock
+                sequence_numbers[i] = current_number_to_distribute++;
+                interested[i] = false;
+            }
+        }
+        interested[my_id] = false;
+        return my_sequence_number;
+    }
 
    public:
     Combiner() {
@@ -128,18 +663,25 @@ class Combiner {
     }
 
     uint64_t getAndIncrement(size_t my_id) {
+        stats_counters.add(Stat::OPERATIONS);
+        stats_counters.add(Stat::SHARED_RMWS);
         interested.at(my_id).store(true);
         queued.fetch_add(1);
 
         while (true) {
-            std::unique_lock guard(lock);
+            stats_counters.add(Stat::SHARED_RMWS);
+            std::unique_lock guard(lock, std::defer_lock);
+            lockCounted(guard);
 
             // happy path, someone else already got the number for me:
             if (!interested[my_id]) {
+                SEQUENCER_PROBE2(waiter_released, this, 0);
                 uint64_t my_sequence_number = sequence_numbers[my_id];
                 return my_sequence_number;
             }
 
+            SEQUENCER_PROBE1(combiner_acquire, this);
+            stats_counters.add(Stat::SHARED_RMWS);
             uint64_t numbers_needed_total = queued.exchange(0);
 
             if (numbers_needed_total == 0) {
@@ -154,110 +696,4163 @@ class Combiner {
                 // the shared atomic, but this would require that the queued
                 // counter can go negative. Instead, I can also just retry
                 // grabbing the lock
+                stats_counters.add(Stat::FALLBACKS);
                 continue;
             }
 
-            uint64_t distribute_range_lower = counter_combiner.fetch_add(numbers_needed_total);
-            uint64_t distribute_range_upper = distribute_range_lower + numbers_needed_total;
+            return distribute(my_id, numbers_needed_total);
+        }
+    }
+
+    // Snapshots for monitoring. current() reads the shared counter: every number handed out is
+    // below it, though some of the numbers below it may still be on their way to a waiter.
+    // lowerBound() is this combiner's last published batch end, at most current() and read from
+    // a line the increment path does not contend on.
+    uint64_t current() const {
+        return counter_combiner.load();
+    }
+
+    uint64_t lowerBound() const {
+        return high_water.read();
+    }
+
+    // Per-thread counters, summed on read; see StatsCounters.
+    SequencerStats stats() const {
+        return stats_counters.read();
+    }
+
+    // Slots whose interested flag is still raised, e.g. by a thread that exited mid-request.
+    size_t interestedSlots() const {
+        return std::count_if(interested.begin(), interested.end(),
+                             [](const auto& flag) { return flag.load(); });
+    }
 
-            uint64_t my_sequence_number = distribute_range_lower;
+    // Like getAndIncrement, but gives up waiting for the lock once the deadline expires. A
+    // withdrawn request leaves its queued count behind, which costs one unused number later.
+    template <typename Deadline>
+    std::optional<uint64_t> tryGetAndIncrement(size_t my_id, const Deadline& deadline) {
+        stats_counters.add(Stat::OPERATIONS);
+        stats_counters.add(Stat::SHARED_RMWS);
+        interested.at(my_id).store(true);
+        queued.fetch_add(1);
 
-            uint64_t current_number_to_distribute = my_sequence_number + 1;
-            for (size_t i = 0; i < NUMBER && current_number_to_distribute < distribute_range_upper;
-                 i++) {
-                if (i != my_id && interested[i]) {
-                    interested[i] = false;
-                    sequence_numbers[i] = current_number_to_distribute++;
+        size_t spins = 0;
+        while (true) {
+            stats_counters.add(Stat::SHARED_RMWS);
+            std::unique_lock guard(lock, std::try_to_lock);
+            if (!guard.owns_lock()) {
+                if (!deadline.expired()) {
+                    stats_counters.add(Stat::SPINS);
+                    spinWait(spins);
+                    continue;
                 }
+                bool expected = true;
+                if (interested[my_id].compare_exchange_strong(expected, false)) {
+                    stats_counters.add(Stat::FALLBACKS);
+                    return std::nullopt;
+                }
+                // served in the meantime, the number is published before the flag is cleared
+                return sequence_numbers[my_id].load();
             }
-            interested[my_id] = false;
-            return my_sequence_number;
+
+            if (!interested[my_id]) {
+                return sequence_numbers[my_id].load();
+            }
+
+            stats_counters.add(Stat::SHARED_RMWS);
+            uint64_t numbers_needed_total = queued.exchange(0);
+            if (numbers_needed_total == 0) {
+                // same rare race as in getAndIncrement
+                stats_counters.add(Stat::FALLBACKS);
+                continue;
+            }
+
+            return distribute(my_id, numbers_needed_total);
         }
     }
 };
 
-std::chrono::milliseconds caseCombiner() {
-    std::vector<std::unique_ptr<Combiner<NUM_THREADS_PER_COMBINER>>> combiners;
-    combiners.reserve(NUM_COMBINERS);
-    std::vector<std::thread> threads;
-    threads.reserve(NUM_THREADS);
+std::atomic<uint64_t> counter_combiner_multi_round{0};
+std::atomic<uint64_t> counter_combiner_fair{0};
 
-    auto start_time = std::chrono::high_resolution_clock::now();
+const size_t MULTI_ROUND_MAX_ROUNDS = 16;
+const std::chrono::nanoseconds MULTI_ROUND_TIME_BUDGET{std::chrono::microseconds(2)};
+const size_t FAIR_MAX_CONSECUTIVE_ROUNDS = 4;
 
-    for (int combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
-        auto combiner = std::make_unique<Combiner<NUM_THREADS_PER_COMBINER>>();
-        combiners.emplace_back(std::move(combiner));
+// Like the Combiner, but the combiner keeps serving further rounds while new requests arrive, so
+// that several batches share one acquisition of the combiner role. Waiters therefore must not
+// block (they could never re-announce while the combiner is active): they spin on their own
+// interested flag and only try to take over the role. The role is a flag rather than a mutex so
+// that it can pass from one thread to another.
+// With ROTATING_SCAN, each round starts scanning after the last thread served in the previous
+// round instead of at index 0, so that no slot is systematically served last when a range runs
+// out, and a turn ends by handing the role to the next waiting thread in scan order (as the
+// StackCombiner does), so the outgoing combiner cannot win it straight back with a warm cache.
+template <size_t NUMBER, std::atomic<uint64_t>& COUNTER, bool ROTATING_SCAN = false>
+class MultiRoundCombiner {
+    std::array<std::atomic<bool>, NUMBER> interested;
+    std::atomic<uint32_t> queued;
+    std::atomic<bool> combining{false};
+    // set by a combiner handing the role to the slot (ROTATING_SCAN only)
+    std::array<std::atomic<bool>, NUMBER> hand_off{};
+    std::array<std::atomic<uint64_t>, NUMBER> sequence_numbers;
+    size_t max_rounds;
+    std::chrono::nanoseconds time_budget;
+    // guarded by the combiner role
+    size_t scan_start = 0;
+    PublishedHighWater high_water;
+    StatsCounters stats_counters;
+
+    // Serves one batch of at most queued numbers. If include_me is set, my_id is served first
+    // and its number is returned, otherwise my_id is skipped. Returns false if nothing was queued.
+    bool serveRound(size_t my_id, bool include_me, uint64_t& my_sequence_number) {
+        stats_counters.add(Stat::SHARED_RMWS);
+        uint64_t numbers_needed_total = queued.exchange(0);
+        if (numbers_needed_total == 0) {
+            return false;
+        }
+
+        maybePreempt();
+        SEQUENCER_PROBE2(combine_round, this, numbers_needed_total);
+        stats_counters.add(Stat::COMBINING_ROUNDS);
+        stats_counters.add(Stat::COMBINED_OPERATIONS, numbers_needed_total);
+        stats_counters.add(Stat::SHARED_RMWS);
+        uint64_t distribute_range_lower = COUNTER.fetch_add(numbers_needed_total);
+        uint64_t distribute_range_upper = distribute_range_lower + numbers_needed_total;
+        high_water.publish(distribute_range_upper);
+
+        uint64_t current_number_to_distribute = distribute_range_lower;
+        if (include_me) {
+            my_sequence_number = current_number_to_distribute++;
+        }
+        size_t last_served = scan_start;
+        for (size_t j = 0; j < NUMBER && current_number_to_distribute < distribute_range_upper;
+             j++) {
+            size_t i = ROTATING_SCAN ? (scan_start + j) % NUMBER : j;
+            if (i != my_id && interested[i]) {
+                // publish the number before releasing the waiter, which reads it without the lock
+                sequence_numbers[i] = current_number_to_distribute++;
+                interested[i] = false;
+                last_served = i;
+            }
+        }
+        if constexpr (ROTATING_SCAN) {
+            scan_start = (last_served + 1) % NUMBER;
+        }
+        if (include_me) {
+            interested[my_id] = false;
+        }
+        return true;
     }
 
-    std::atomic<uint64_t> total;
+    // Takes the combiner role if it is free or has been handed to my_id.
+    bool tryAcquireRole(size_t my_id) {
+        if constexpr (ROTATING_SCAN) {
+            if (hand_off[my_id].load() && hand_off[my_id].exchange(false)) {
+                return true;
+            }
+        }
+        return !combining.load(std::memory_order_relaxed) &&
+               !combining.exchange(true, std::memory_order_acquire);
+    }
 
-    // Launch threads
-    for (int combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
-        for (int thread_i = 0; thread_i < NUM_THREADS_PER_COMBINER; thread_i++) {
-            threads.emplace_back([thread_i, combiner_i, &combiners, &total]() {
-                uint64_t my_total = 0;
-                auto& my_combiner = combiners.at(combiner_i);
-                for (uint64_t i = 0; i < COUNT_PER_THREAD; ++i) {
-                    my_total += my_combiner->getAndIncrement(thread_i);
+    // Ends the caller's turn. With ROTATING_SCAN the role goes to the next interested thread
+    // after the last one served, and is only released if nobody waits. A thread that withdraws
+    // its request clears its flag before it checks hand_off, and the combiner sets hand_off before
+    // it checks the flag again, so a handed role is always either taken up or revoked.
+    void endTurn(size_t my_id) {
+        if constexpr (ROTATING_SCAN) {
+            for (size_t j = 0; j < NUMBER; j++) {
+                size_t i = (scan_start + j) % NUMBER;
+                if (i == my_id || !interested[i]) {
+                    continue;
                 }
-                total += my_total;
-            });
+                hand_off[i].store(true);
+                if (interested[i]) {
+                    return;
+                }
+                bool expected = true;
+                if (!hand_off[i].compare_exchange_strong(expected, false)) {
+                    // the withdrawing thread took the role and ends the turn itself
+                    return;
+                }
+            }
         }
+        combining.store(false, std::memory_order_release);
     }
 
-    for (auto& thread : threads) {
-        thread.join();
+   public:
+    explicit MultiRoundCombiner(size_t max_rounds = MULTI_ROUND_MAX_ROUNDS,
+                                std::chrono::nanoseconds time_budget = MULTI_ROUND_TIME_BUDGET)
+        : max_rounds(max_rounds),
+          time_budget(time_budget) {
+        queued = 0;
+        for (auto& val : interested) {
+            val = false;
+        }
     }
 
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-    auto duration = millis.count();
+    uint64_t getAndIncrement(size_t my_id) {
+        stats_counters.add(Stat::OPERATIONS);
+        stats_counters.add(Stat::SHARED_RMWS);
+        interested.at(my_id).store(true);
+        queued.fetch_add(1);
 
-    double seconds = static_cast<double>(duration) / 1000.0;
-    double throughput = static_cast<double>(TOTAL_OPERATIONS) / seconds;
+        size_t spins = 0;
+        while (true) {
+            if (!interested[my_id]) {
+                SEQUENCER_PROBE2(waiter_released, this, spins);
+                return sequence_numbers[my_id];
+            }
+            stats_counters.add(Stat::SHARED_RMWS);
+            if (!tryAcquireRole(my_id)) {
+                stats_counters.add(Stat::SPINS);
+                spinWait(spins);
+                continue;
+            }
 
-    std::cout << "\n=== Results Combiner ===\n";
-    std::cout << "Total sum: " << total.load() << '\n';
-    std::cout << "Duration: " << seconds << " seconds\n";
-    std::cout << "Throughput: " << static_cast<uint64_t>(throughput) << " ops/sec\n";
-    std::cout << "Throughput: " << (throughput / 1000000.0) << " million ops/sec\n";
-    std::cout << "Final counter value: " << counter_combiner.load() << "\n";
-    std::cout << "Threads: " << NUM_THREADS << "\n";
-    return millis;
-}
+            // I might have been served between the check and acquiring the role
+            if (!interested[my_id]) {
+                endTurn(my_id);
+                SEQUENCER_PROBE2(waiter_released, this, spins);
+                return sequence_numbers[my_id];
+            }
 
-void printTableHeader() {
-    std::cout << "| Implementation | Duration | Throughput (ops/sec) | Throughput (M ops/sec) | "
-                 "Relative Performance |\n"
-              << "|------------|----------|---------------------|------------------|---------------"
-                 "------|\n";
-}
+            SEQUENCER_PROBE1(combiner_acquire, this);
+            uint64_t my_sequence_number;
+            if (!serveRound(my_id, true, my_sequence_number)) {
+                // Same rare race as in the Combiner: my queue value was consumed by a combiner
+                // that did not select me. Its increment is still pending, so just retry.
+                stats_counters.add(Stat::FALLBACKS);
+                endTurn(my_id);
+                continue;
+            }
 
-void printTableLine(std::string implementation_name,
-                    std::chrono::milliseconds time,
-                    std::chrono::milliseconds min_time) {
-    double throughput =
-        (static_cast<double>(TOTAL_OPERATIONS) * 1000.0) / static_cast<double>(time.count());
-    double min_throughput =
-        (static_cast<double>(TOTAL_OPERATIONS) * 1000.0) / static_cast<double>(min_time.count());
-    std::cout << std::format("| {} | {}.{:03} | {} | {} | {:.2f} |\n", implementation_name,
-                             time.count() / 1000, time.count() % 1000, throughput,
-                             throughput / 1000000, throughput / min_throughput);
-}
+            // Keep the combiner role while requests keep arriving: the turn ends with the first
+            // round that finds nothing queued, after max_rounds rounds or after the time budget.
+            auto start = std::chrono::steady_clock::now();
+            size_t rounds = 1;
+            uint64_t unused;
+            while (rounds < max_rounds && std::chrono::steady_clock::now() - start < time_budget &&
+                   serveRound(my_id, false, unused)) {
+                rounds++;
+            }
+            endTurn(my_id);
+            return my_sequence_number;
+        }
+    }
 
-}  // namespace
+    // Snapshots for monitoring, see Combiner.
+    uint64_t current() const {
+        return COUNTER.load();
+    }
 
-int main() {
-    std::chrono::milliseconds lock_time = caseLock();
-    std::chrono::milliseconds simple_time = caseSimple();
-    std::chrono::milliseconds combiner_time = caseCombiner();
+    uint64_t lowerBound() const {
+        return high_water.read();
+    }
 
-    std::chrono::milliseconds min_time = std::min({lock_time, simple_time, combiner_time});
+    SequencerStats stats() const {
+        return stats_counters.read();
+    }
 
-    printTableHeader();
-    printTableLine("Lock", lock_time, min_time);
-    printTableLine("Simple CAS", simple_time, min_time);
-    printTableLine("Combiner", combiner_time, min_time);
+    // See Combiner.
+    size_t interestedSlots() const {
+        return std::count_if(interested.begin(), interested.end(),
+                             [](const auto& flag) { return flag.load(); });
+    }
+
+    // Like getAndIncrement, but gives up waiting once the deadline expires. When this thread ends
+    // up as combiner it serves a single round, so the caller's budget is not spent on others.
+    template <typename Deadline>
+    std::optional<uint64_t> tryGetAndIncrement(size_t my_id, const Deadline& deadline) {
+        stats_counters.add(Stat::OPERATIONS);
+        stats_counters.add(Stat::SHARED_RMWS);
+        interested.at(my_id).store(true);
+        queued.fetch_add(1);
+
+        size_t spins = 0;
+        while (true) {
+            if (!interested[my_id]) {
+                return sequence_numbers[my_id].load();
+            }
+            stats_counters.add(Stat::SHARED_RMWS);
+            if (!tryAcquireRole(my_id)) {
+                if (!deadline.expired()) {
+                    stats_counters.add(Stat::SPINS);
+                    spinWait(spins);
+                    continue;
+                }
+                bool expected = true;
+                if (interested[my_id].compare_exchange_strong(expected, false)) {
+                    stats_counters.add(Stat::FALLBACKS);
+                    if constexpr (ROTATING_SCAN) {
+                        // the role may have been handed to me just now, pass it on
+                        if (hand_off[my_id].exchange(false)) {
+                            endTurn(my_id);
+                        }
+                    }
+                    return std::nullopt;
+                }
+                // served in the meantime, the number is published before the flag is cleared
+                return sequence_numbers[my_id].load();
+            }
+
+            if (!interested[my_id]) {
+                endTurn(my_id);
+                return sequence_numbers[my_id].load();
+            }
+
+            uint64_t my_sequence_number;
+            bool served = serveRound(my_id, true, my_sequence_number);
+            endTurn(my_id);
+            if (served) {
+                return my_sequence_number;
+            }
+        }
+    }
+};
+
+template <size_t NUMBER>
+using FairCombiner = MultiRoundCombiner<NUMBER, counter_combiner_fair, true>;
+
+// Scalable non-zero indicator (Ellen, Lev, Luchangco, Moir; PODC 2007): arrive/depart only touch
+// the caller's leaf, except when a leaf's surplus changes between zero and non-zero, and query
+// reads a single word that changes only then. The leaves follow the hierarchical SNZI algorithm
+// with its intermediate "1/2" state; the root is a plain surplus counter, which is a valid (if
+// less scalable) SNZI by itself.
+template <size_t LEAVES>
+class Snzi {
+    // Leaf state: surplus counted in halves in the upper 32 bits (1 is the intermediate 1/2
+    // state), version number in the lower 32 bits.
+    struct alignas(CACHE_LINE_SIZE) Leaf {
+        std::atomic<uint64_t> state{0};
+    };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> root{0};
+    std::array<Leaf, LEAVES> leaves;
+
+    static uint64_t halves(uint64_t state) {
+        return state >> 32;
+    }
+
+    static uint64_t version(uint64_t state) {
+        return state & 0xFFFFFFFF;
+    }
+
+    static uint64_t makeState(uint64_t halves, uint64_t version) {
+        return (halves << 32) | (version & 0xFFFFFFFF);
+    }
+
+   public:
+    void arrive(size_t leaf) {
+        auto& state = leaves.at(leaf).state;
+        bool succeeded = false;
+        size_t undo_arrivals = 0;
+        while (!succeeded) {
+            uint64_t x = state.load();
+            uint64_t expected = x;
+            if (halves(x) >= 2) {
+                succeeded = state.compare_exchange_strong(expected, makeState(halves(x) + 2,
+                                                                              version(x)));
+            }
+            if (halves(x) == 0) {
+                uint64_t half = makeState(1, version(x) + 1);
+                if (state.compare_exchange_strong(expected, half)) {
+                    succeeded = true;
+                    x = half;
+                }
+            }
+            if (halves(x) == 1) {
+                root.fetch_add(1);
+                expected = x;
+                if (!state.compare_exchange_strong(expected, makeState(2, version(x)))) {
+                    undo_arrivals++;
+                }
+            }
+            if (!succeeded) {
+                SEQUENCER_PROBE1(cas_retry, this);
+            }
+        }
+        for (; undo_arrivals > 0; undo_arrivals--) {
+            root.fetch_sub(1);
+        }
+    }
+
+    void depart(size_t leaf) {
+        auto& state = leaves.at(leaf).state;
+        while (true) {
+            uint64_t x = state.load();
+            if (state.compare_exchange_weak(x, makeState(halves(x) - 2, version(x)))) {
+                if (halves(x) == 2) {
+                    root.fetch_sub(1);
+                }
+                return;
+            }
+            SEQUENCER_PROBE1(cas_retry, this);
+        }
+    }
+
+    bool query() const {
+        return root.load() != 0;
+    }
+
+    // Leaves with a surplus, i.e. with an arrival that has not departed.
+    size_t nonZeroLeaves() const {
+        return std::count_if(leaves.begin(), leaves.end(),
+                             [](const Leaf& leaf) { return halves(leaf.state.load()) != 0; });
+    }
+};
+
+std::atomic<uint64_t> counter_combiner_snzi{0};
+
+const size_t SNZI_THREADS_PER_LEAF = 2;
+
+// Multi-round combiner without the shared queued counter: requesters only raise their flag and
+// arrive at their SNZI leaf. The combiner sizes each batch by counting the raised flags, so no
+// numbers are lost to over-counting, and between rounds it polls the SNZI root instead of
+// exchanging a contended counter.
+template <size_t NUMBER, size_t THREADS_PER_LEAF = SNZI_THREADS_PER_LEAF>
+class SnziCombiner {
+    std::array<std::atomic<bool>, NUMBER> interested;
+    std::mutex lock;
+    std::array<std::atomic<uint64_t>, NUMBER> sequence_numbers;
+    Snzi<(NUMBER + THREADS_PER_LEAF - 1) / THREADS_PER_LEAF> pending;
+    PublishedHighWater high_water;
+    StatsCounters stats_counters;
+    size_t max_rounds;
+    std::chrono::nanoseconds time_budget;
+
+    static size_t leafOf(size_t my_id) {
+        return my_id / THREADS_PER_LEAF;
+    }
+
+    // Serves every thread that is interested at the time of the count. Flags are only cleared by
+    // the lock holder (or by a withdrawing tryGetAndIncrement), so the batch is used up exactly.
+    // Returns false if nobody was interested.
+    bool serveRound(size_t my_id, bool include_me, uint64_t& my_sequence_number) {
+        uint64_t numbers_needed_total = 0;
+        for (size_t i = 0; i < NUMBER; i++) {
+            if (interested[i] && (include_me || i != my_id)) {
+                numbers_needed_total++;
+            }
+        }
+        if (numbers_needed_total == 0) {
+            return false;
+        }
+
+        maybePreempt();
+        SEQUENCER_PROBE2(combine_round, this, numbers_needed_total);
+        stats_counters.add(Stat::COMBINING_ROUNDS);
+        stats_counters.add(Stat::COMBINED_OPERATIONS, numbers_needed_total);
+        stats_counters.add(Stat::SHARED_RMWS);
+        uint64_t distribute_range_lower = counter_combiner_snzi.fetch_add(numbers_needed_total);
+        uint64_t distribute_range_upper = distribute_range_lower + numbers_needed_total;
+        high_water.publish(distribute_range_upper);
+
+        uint64_t current_number_to_distribute = distribute_range_lower;
+        if (include_me) {
+            my_sequence_number = current_number_to_distribute++;
+        }
+        for (size_t i = 0; i < NUMBER && current_number_to_distribute < distribute_range_upper;
+             i++) {
+            if (i != my_id && interested[i]) {
+                sequence_numbers[i] = current_number_to_distribute++;
+                interested[i] = false;
+            }
+        }
+        if (include_me) {
+            interested[my_id] = false;
+        }
+        return true;
+    }
+
+   public:
+    explicit SnziCombiner(size_t max_rounds = MULTI_ROUND_MAX_ROUNDS,
+                          std::chrono::nanoseconds time_budget = MULTI_ROUND_TIME_BUDGET)
+        : max_rounds(max_rounds),
+          time_budget(time_budget) {
+        for (auto& val : interested) {
+            val = false;
+        }
+    }
+
+    uint64_t getAndIncrement(size_t my_id) {
+        // arrive and depart on the leaf, which is shared with the leaf's other threads
+        stats_counters.add(Stat::OPERATIONS);
+        stats_counters.add(Stat::SHARED_RMWS, 2);
+        interested.at(my_id).store(true);
+        pending.arrive(leafOf(my_id));
+
+        size_t spins = 0;
+        while (interested[my_id]) {
+            stats_counters.add(Stat::SHARED_RMWS);
+            if (!lock.try_lock()) {
+                stats_counters.add(Stat::SPINS);
+                spinWait(spins);
+                continue;
+            }
+            std::unique_lock guard(lock, std::adopt_lock);
+
+            if (!interested[my_id]) {
+                break;
+            }
+
+            SEQUENCER_PROBE1(combiner_acquire, this);
+            // I am interested myself, so this round always serves me
+            uint64_t my_sequence_number = 0;
+            serveRound(my_id, true, my_sequence_number);
+            // depart before polling, otherwise my own arrival keeps the indicator set
+            pending.depart(leafOf(my_id));
+
+            // the turn ends as soon as the indicator reports nobody pending
+            auto start = std::chrono::steady_clock::now();
+            size_t rounds = 1;
+            uint64_t unused;
+            while (rounds < max_rounds && std::chrono::steady_clock::now() - start < time_budget &&
+                   pending.query() && serveRound(my_id, false, unused)) {
+                rounds++;
+            }
+            return my_sequence_number;
+        }
+        SEQUENCER_PROBE2(waiter_released, this, spins);
+        pending.depart(leafOf(my_id));
+        return sequence_numbers[my_id];
+    }
+
+    // Snapshots for monitoring, see Combiner.
+    uint64_t current() const {
+        return counter_combiner_snzi.load();
+    }
+
+    uint64_t lowerBound() const {
+        return high_water.read();
+    }
+
+    SequencerStats stats() const {
+        return stats_counters.read();
+    }
+
+    // See Combiner; a departed thread also leaves no surplus on its SNZI leaf.
+    size_t interestedSlots() const {
+        return std::count_if(interested.begin(), interested.end(),
+                             [](const auto& flag) { return flag.load(); });
+    }
+
+    size_t pendingLeaves() const {
+        return pending.nonZeroLeaves();
+    }
+
+    // Like getAndIncrement, but gives up waiting once the deadline expires and serves a single
+    // round as combiner. A request withdrawn after being counted leaves an unused number behind.
+    template <typename Deadline>
+    std::optional<uint64_t> tryGetAndIncrement(size_t my_id, const Deadline& deadline) {
+        stats_counters.add(Stat::OPERATIONS);
+        stats_counters.add(Stat::SHARED_RMWS, 2);
+        interested.at(my_id).store(true);
+        pending.arrive(leafOf(my_id));
+
+        size_t spins = 0;
+        while (interested[my_id]) {
+            stats_counters.add(Stat::SHARED_RMWS);
+            if (!lock.try_lock()) {
+                if (!deadline.expired()) {
+                    stats_counters.add(Stat::SPINS);
+                    spinWait(spins);
+                    continue;
+                }
+                bool expected = true;
+                if (interested[my_id].compare_exchange_strong(expected, false)) {
+                    stats_counters.add(Stat::FALLBACKS);
+                    pending.depart(leafOf(my_id));
+                    return std::nullopt;
+                }
+                break;
+            }
+            std::unique_lock guard(lock, std::adopt_lock);
+
+            if (!interested[my_id]) {
+                break;
+            }
+
+            // I am interested myself, so this round always serves me
+            uint64_t my_sequence_number = 0;
+            serveRound(my_id, true, my_sequence_number);
+            pending.depart(leafOf(my_id));
+            return my_sequence_number;
+        }
+        pending.depart(leafOf(my_id));
+        return sequence_numbers[my_id].load();
+    }
+};
+
+template <typename CombinerType, typename... Args>
+std::chrono::milliseconds caseCombiner(const std::string& name,
+                                       const std::atomic<uint64_t>& counter,
+                                       const Args&... args) {
+    std::vector<std::unique_ptr<CombinerType>> combiners;
+    combiners.reserve(NUM_COMBINERS);
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    for (int combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+        auto combiner = std::make_unique<CombinerType>(args...);
+        combiners.emplace_back(std::move(combiner));
+    }
+
+    std::atomic<uint64_t> total;
+
+    // Launch threads
+    for (int combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+        for (int thread_i = 0; thread_i < NUM_THREADS_PER_COMBINER; thread_i++) {
+            threads.emplace_back([thread_i, combiner_i, &combiners, &total]() {
+                uint64_t my_total = 0;
+                auto& my_combiner = combiners.at(combiner_i);
+                for (uint64_t i = 0; i < COUNT_PER_THREAD; ++i) {
+                    my_total += my_combiner->getAndIncrement(thread_i);
+                    countCompleted(i);
+                }
+                total += my_total;
+            });
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    auto duration = millis.count();
+
+    double seconds = static_cast<double>(duration) / 1000.0;
+    double throughput = static_cast<double>(TOTAL_OPERATIONS) / seconds;
+
+    std::cout << "\n=== Results " << name << " ===\n";
+    std::cout << "Total sum: " << total.load() << '\n';
+    std::cout << "Duration: " << seconds << " seconds\n";
+    std::cout << "Throughput: " << static_cast<uint64_t>(throughput) << " ops/sec\n";
+    std::cout << "Throughput: " << (throughput / 1000000.0) << " million ops/sec\n";
+    std::cout << "Final counter value: " << counter.load() << "\n";
+    std::cout << "Threads: " << NUM_THREADS << "\n";
+    return millis;
+}
+
+std::atomic<uint64_t> counter_combiner_stack{0};
+
+const size_t STACK_COMBINER_MAX_ROUNDS = 16;
+
+// Combiner without a mutex, a fixed group size or thread ids. Requesters push a request node that
+// lives on their own stack onto an atomic list; whoever pushes onto an idle (empty) list becomes
+// the combiner. The combiner takes the whole list with one exchange, serves it with one fetch_add
+// and repeats until it can mark the list idle again. After max_rounds it hands the role, along
+// with its number, to a requester of the current batch instead, so a combiner cannot be kept busy
+// forever. A pushed request cannot be withdrawn, so there is no tryGetAndIncrement.
+class StackCombiner {
+    enum class State : uint8_t { WAITING, SERVED, COMBINE };
+
+    struct Request {
+        Request* next = nullptr;
+        uint64_t sequence_number = 0;
+        std::atomic<State> state{State::WAITING};
+    };
+
+    // head of the request list: nullptr if idle, &busy if a combiner is active and nothing is
+    // pending. Requests pushed onto &busy end the list with nullptr.
+    alignas(CACHE_LINE_SIZE) std::atomic<Request*> requests{nullptr};
+    Request busy;
+    size_t max_rounds;
+    PublishedHighWater high_water;
+    StatsCounters stats_counters;
+
+    // Serves the list; with hand_off the first request becomes the next combiner. Requests must
+    // not be touched after their state is set, their owners return right away.
+    void serve(Request* batch, bool hand_off) {
+        uint64_t numbers_needed_total = 0;
+        for (Request* request = batch; request != nullptr; request = request->next) {
+            numbers_needed_total++;
+        }
+        maybePreempt();
+        SEQUENCER_PROBE2(combine_round, this, numbers_needed_total);
+        stats_counters.add(Stat::COMBINING_ROUNDS);
+        stats_counters.add(Stat::COMBINED_OPERATIONS, numbers_needed_total);
+        stats_counters.add(Stat::SHARED_RMWS);
+        uint64_t current_number_to_distribute =
+            counter_combiner_stack.fetch_add(numbers_needed_total);
+        high_water.publish(current_number_to_distribute + numbers_needed_total);
+        while (batch != nullptr) {
+            Request* next = batch->next;
+            batch->sequence_number = current_number_to_distribute++;
+            batch->state = hand_off ? State::COMBINE : State::SERVED;
+            hand_off = false;
+            batch = next;
+        }
+    }
+
+    void combine() {
+        SEQUENCER_PROBE1(combiner_acquire, this);
+        for (size_t rounds = 1;; rounds++) {
+            // the attempt to go idle and the exchange taking the list
+            stats_counters.add(Stat::SHARED_RMWS, 2);
+            Request* expected = &busy;
+            if (requests.compare_exchange_strong(expected, nullptr)) {
+                return;
+            }
+            // Only the initial combiner's own request is in its first batch, so from round two
+            // on the batch holds other threads only.
+            bool hand_off = rounds >= max_rounds && rounds > 1;
+            serve(requests.exchange(&busy), hand_off);
+            if (hand_off) {
+                return;
+            }
+        }
+    }
+
+   public:
+    explicit StackCombiner(size_t max_rounds = STACK_COMBINER_MAX_ROUNDS)
+        : max_rounds(max_rounds) {}
+
+    uint64_t getAndIncrement() {
+        stats_counters.add(Stat::OPERATIONS);
+        Request request;
+        Request* head = requests.load();
+        while (true) {
+            stats_counters.add(Stat::SHARED_RMWS);
+            request.next = head == &busy ? nullptr : head;
+            if (requests.compare_exchange_weak(head, &request)) {
+                break;
+            }
+            SEQUENCER_PROBE1(cas_retry, this);
+        }
+
+        if (head != nullptr) {
+            size_t spins = 0;
+            State state;
+            while ((state = request.state.load()) == State::WAITING) {
+                stats_counters.add(Stat::SPINS);
+                spinWait(spins);
+            }
+            if (state == State::SERVED) {
+                SEQUENCER_PROBE2(waiter_released, this, spins);
+                return request.sequence_number;
+            }
+        }
+        // Either the list was idle or the role was handed to me. In the first case my request is
+        // served in the first round like any other.
+        combine();
+        return request.sequence_number;
+    }
+
+    // Snapshots for monitoring, see Combiner.
+    uint64_t current() const {
+        return counter_combiner_stack.load();
+    }
+
+    uint64_t lowerBound() const {
+        return high_water.read();
+    }
+
+    SequencerStats stats() const {
+        return stats_counters.read();
+    }
+};
+
+std::chrono::milliseconds caseStackCombiner() {
+    StackCombiner combiner;
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::atomic<uint64_t> total;
+
+    // Launch threads, all sharing the one combiner
+    for (size_t i = 0; i < NUM_THREADS; i++) {
+        threads.emplace_back([&total, &combiner]() {
+            uint64_t my_total = 0;
+            for (uint64_t i = 0; i < COUNT_PER_THREAD; ++i) {
+                my_total += combiner.getAndIncrement();
+                countCompleted(i);
+            }
+            total += my_total;
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    auto duration = millis.count();
+
+    double seconds = static_cast<double>(duration) / 1000.0;
+    double throughput = static_cast<double>(TOTAL_OPERATIONS) / seconds;
+
+    std::cout << "\n=== Results Stack Combiner ===\n";
+    std::cout << "Total sum: " << total.load() << '\n';
+    std::cout << "Duration: " << seconds << " seconds\n";
+    std::cout << "Throughput: " << static_cast<uint64_t>(throughput) << " ops/sec\n";
+    std::cout << "Throughput: " << (throughput / 1000000.0) << " million ops/sec\n";
+    std::cout << "Final counter value: " << counter_combiner_stack.load() << "\n";
+    std::cout << "Threads: " << NUM_THREADS << "\n";
+    return millis;
+}
+
+// Parses a sysfs cpu list such as "0-7,16-23".
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// Reads a per-cpu sysfs file, e.g. "cache/index3/shared_cpu_list". Empty if it does not exist.
+std::string readCpuSysfs(int cpu, const std::string& file) {
+    std::ifstream stream(std::format("/sys/devices/system/cpu/cpu{}/{}", cpu, file));
+    std::string content;
+    std::getline(stream, content);
+    return content;
+}
+
+// Groups the cpus by shared last-level (L3) cache. Without sysfs topology, all cpus form one
+// domain.
+std::vector<std::vector<int>> detectLlcDomains() {
+    int num_cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (readCpuSysfs(0, "cache/index3/shared_cpu_list").empty()) {
+        std::vector<int> all_cpus;
+        for (int cpu = 0; cpu < num_cpus; cpu++) {
+            all_cpus.push_back(cpu);
+        }
+        return {all_cpus};
+    }
+    std::map<int, std::vector<int>> domains_by_first_cpu;
+    for (int cpu = 0; cpu < num_cpus; cpu++) {
+        std::vector<int> shared = parseCpuList(readCpuSysfs(cpu, "cache/index3/shared_cpu_list"));
+        if (shared.empty()) {
+            shared = {cpu};
+        }
+        domains_by_first_cpu.emplace(shared.front(), shared);
+    }
+    std::vector<std::vector<int>> domains;
+    for (auto& [first_cpu, cpus] : domains_by_first_cpu) {
+        domains.push_back(cpus);
+    }
+    return domains;
+}
+
+// Best effort: pinning is only supported on Linux.
+void pinCurrentThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+std::atomic<uint64_t> counter_delegation{0};
+
+// Hierarchical delegation: one server thread per LLC domain polls the request slots of its local
+// clients and obtains the numbers for a whole sweep with one fetch_add on the global counter.
+// Client-server traffic stays within the domain, only the global counter line crosses domains,
+// once per sweep.
+class DelegationSequencer {
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<bool> pending{false};
+        uint64_t sequence_number = 0;
+    };
+
+    struct Domain {
+        std::unique_ptr<Slot[]> slots;
+        std::thread server;
+        PublishedHighWater high_water;
+    };
+
+    std::vector<Domain> domains;
+    size_t clients_per_domain;
+    std::atomic<bool> stop{false};
+    StatsCounters stats_counters;
+
+    void serve(Slot* slots, PublishedHighWater& high_water) {
+        std::vector<size_t> requesters;
+        requesters.reserve(clients_per_domain);
+        size_t spins = 0;
+        while (!stop) {
+            requesters.clear();
+            for (size_t i = 0; i < clients_per_domain; i++) {
+                if (slots[i].pending.load(std::memory_order_acquire)) {
+                    requesters.push_back(i);
+                }
+            }
+            if (requesters.empty()) {
+                spinWait(spins);
+                continue;
+            }
+            SEQUENCER_PROBE2(combine_round, this, requesters.size());
+            stats_counters.add(Stat::COMBINING_ROUNDS);
+            stats_counters.add(Stat::COMBINED_OPERATIONS, requesters.size());
+            stats_counters.add(Stat::SHARED_RMWS);
+            uint64_t current_number_to_distribute = counter_delegation.fetch_add(requesters.size());
+            high_water.publish(current_number_to_distribute + requesters.size());
+            for (size_t i : requesters) {
+                slots[i].sequence_number = current_number_to_distribute++;
+                slots[i].pending.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+   public:
+    // Starts one server per domain, pinned to the domain's first cpu.
+    DelegationSequencer(const std::vector<std::vector<int>>& llc_domains, size_t clients_per_domain)
+        : domains(llc_domains.size()),
+          clients_per_domain(clients_per_domain) {
+        for (size_t domain_i = 0; domain_i < domains.size(); domain_i++) {
+            auto& domain = domains[domain_i];
+            domain.slots = std::make_unique<Slot[]>(clients_per_domain);
+            domain.server = std::thread([this, &domain, cpu = llc_domains[domain_i].front()]() {
+                pinCurrentThread(cpu);
+                serve(domain.slots.get(), domain.high_water);
+            });
+        }
+    }
+
+    ~DelegationSequencer() {
+        stop = true;
+        for (auto& domain : domains) {
+            domain.server.join();
+        }
+    }
+
+    uint64_t getAndIncrement(size_t domain, size_t my_id) {
+        stats_counters.add(Stat::OPERATIONS);
+        auto& slot = domains.at(domain).slots[my_id];
+        slot.pending.store(true, std::memory_order_release);
+        size_t spins = 0;
+        while (slot.pending.load(std::memory_order_acquire)) {
+            stats_counters.add(Stat::SPINS);
+            spinWait(spins);
+        }
+        SEQUENCER_PROBE2(waiter_released, this, spins);
+        return slot.sequence_number;
+    }
+
+    // Snapshots for monitoring, see Combiner. The lower bound is the largest batch end any
+    // server published.
+    uint64_t current() const {
+        return counter_delegation.load();
+    }
+
+    uint64_t lowerBound() const {
+        uint64_t lower_bound = 0;
+        for (const auto& domain : domains) {
+            lower_bound = std::max(lower_bound, domain.high_water.read());
+        }
+        return lower_bound;
+    }
+
+    // Rounds are server sweeps; the servers' idle polling is not counted as spins.
+    SequencerStats stats() const {
+        return stats_counters.read();
+    }
+};
+
+std::chrono::milliseconds caseDelegation() {
+    auto llc_domains = detectLlcDomains();
+    size_t clients_per_domain = (NUM_THREADS + llc_domains.size() - 1) / llc_domains.size();
+    DelegationSequencer sequencer(llc_domains, clients_per_domain);
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::atomic<uint64_t> total;
+
+    // Launch threads, spread round-robin over the domains and pinned to the domain's cpus other
+    // than the server's where possible
+    for (size_t i = 0; i < NUM_THREADS; i++) {
+        size_t domain = i % llc_domains.size();
+        size_t my_id = i / llc_domains.size();
+        const auto& cpus = llc_domains[domain];
+        int cpu = cpus.size() > 1 ? cpus[1 + my_id % (cpus.size() - 1)] : cpus.front();
+        threads.emplace_back([&total, &sequencer, domain, my_id, cpu]() {
+            pinCurrentThread(cpu);
+            uint64_t my_total = 0;
+            for (uint64_t i = 0; i < COUNT_PER_THREAD; ++i) {
+                my_total += sequencer.getAndIncrement(domain, my_id);
+                countCompleted(i);
+            }
+            total += my_total;
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    auto duration = millis.count();
+
+    double seconds = static_cast<double>(duration) / 1000.0;
+    double throughput = static_cast<double>(TOTAL_OPERATIONS) / seconds;
+
+    std::cout << "\n=== Results Delegation ===\n";
+    std::cout << "Total sum: " << total.load() << '\n';
+    std::cout << "Duration: " << seconds << " seconds\n";
+    std::cout << "Throughput: " << static_cast<uint64_t>(throughput) << " ops/sec\n";
+    std::cout << "Throughput: " << (throughput / 1000000.0) << " million ops/sec\n";
+    std::cout << "Final counter value: " << counter_delegation.load() << "\n";
+    std::cout << "Threads: " << NUM_THREADS << " (+ " << llc_domains.size()
+              << " LLC domain servers)\n";
+    return millis;
+}
+
+std::atomic<uint64_t> counter_bulk{0};
+
+const size_t BULK_PHASES = 100;
+
+// Sequencer for bulk-synchronous phases. During a phase, threads only record how many numbers
+// they will need in the next one. At the phase barrier the completion step computes the prefix
+// sum of all requests, takes the whole total with a single fetch_add and hands every thread a
+// contiguous range, which it then uses without any synchronisation. The prefix sum runs on the
+// one thread completing the barrier; with one count per thread it is cheaper than a parallel scan.
+// Taking more numbers than requested falls back to the shared counter.
+template <size_t NUMBER>
+class BulkSynchronousSequencer {
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        uint64_t requested = 0;
+        uint64_t next = 0;
+        uint64_t end = 0;
+    };
+
+    struct AssignRanges {
+        BulkSynchronousSequencer* sequencer;
+
+        void operator()() noexcept {
+            uint64_t total = 0;
+            for (auto& slot : sequencer->slots) {
+                total += slot.requested;
+            }
+            uint64_t next = counter_bulk.fetch_add(total);
+            for (auto& slot : sequencer->slots) {
+                slot.next = next;
+                slot.end = next + slot.requested;
+                next = slot.end;
+                slot.requested = 0;
+            }
+        }
+    };
+
+    std::array<Slot, NUMBER> slots;
+    std::barrier<AssignRanges> phase_barrier;
+
+   public:
+    BulkSynchronousSequencer()
+        : phase_barrier(NUMBER, AssignRanges{this}) {}
+
+    // Adds to the numbers my_id needs in the next phase.
+    void request(size_t my_id, uint64_t count) {
+        slots.at(my_id).requested += count;
+    }
+
+    // Ends the phase; all NUMBER threads must call it. Unused numbers of the phase are lost.
+    void arriveAndWait() {
+        phase_barrier.arrive_and_wait();
+    }
+
+    uint64_t getAndIncrement(size_t my_id) {
+        auto& slot = slots[my_id];
+        if (slot.next < slot.end) {
+            return slot.next++;
+        }
+        return counter_bulk.fetch_add(1);
+    }
+};
+
+std::chrono::milliseconds caseBulkSynchronous() {
+    auto sequencer = std::make_unique<BulkSynchronousSequencer<NUM_THREADS>>();
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    const uint64_t count_per_phase = COUNT_PER_THREAD / BULK_PHASES;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    std::atomic<uint64_t> total;
+
+    // Launch threads, each requesting its numbers one phase ahead
+    for (size_t thread_i = 0; thread_i < NUM_THREADS; thread_i++) {
+        threads.emplace_back([&total, &sequencer, thread_i, count_per_phase]() {
+            uint64_t my_total = 0;
+            sequencer->request(thread_i, count_per_phase);
+            sequencer->arriveAndWait();
+            for (size_t phase = 0; phase < BULK_PHASES; phase++) {
+                for (uint64_t i = 0; i < count_per_phase; ++i) {
+                    my_total += sequencer->getAndIncrement(thread_i);
+                    countCompleted(phase * count_per_phase + i);
+                }
+                if (phase + 1 < BULK_PHASES) {
+                    sequencer->request(thread_i, count_per_phase);
+                }
+                sequencer->arriveAndWait();
+            }
+            total += my_total;
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    auto duration = millis.count();
+
+    double seconds = static_cast<double>(duration) / 1000.0;
+    double throughput = static_cast<double>(TOTAL_OPERATIONS) / seconds;
+
+    std::cout << "\n=== Results Bulk Synchronous ===\n";
+    std::cout << "Total sum: " << total.load() << '\n';
+    std::cout << "Duration: " << seconds << " seconds\n";
+    std::cout << "Throughput: " << static_cast<uint64_t>(throughput) << " ops/sec\n";
+    std::cout << "Throughput: " << (throughput / 1000000.0) << " million ops/sec\n";
+    std::cout << "Final counter value: " << counter_bulk.load() << "\n";
+    std::cout << "Threads: " << NUM_THREADS << ", phases: " << BULK_PHASES << "\n";
+    return millis;
+}
+
+const size_t LATENCY_SAMPLE_INTERVAL = 64;
+const size_t FAIRNESS_COUNT_PER_THREAD = COUNT_PER_THREAD / 10;
+
+// Returns the given percentile (0.0 - 1.0) of the samples, reordering them in the process.
+uint64_t percentile(std::vector<uint64_t>& samples, double fraction) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = std::min(samples.size() - 1,
+                            static_cast<size_t>(fraction * static_cast<double>(samples.size())));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+// Reruns a combiner while timing every LATENCY_SAMPLE_INTERVAL-th request and prints the latency
+// distribution per thread, to show whether some slots are systematically served later.
+template <typename CombinerType, typename... Args>
+void caseCombinerFairness(const std::string& name, const Args&... args) {
+    std::vector<std::unique_ptr<CombinerType>> combiners;
+    combiners.reserve(NUM_COMBINERS);
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::vector<std::vector<uint64_t>> latencies(NUM_THREADS);
+
+    for (size_t combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+        combiners.emplace_back(std::make_unique<CombinerType>(args...));
+    }
+
+    for (size_t combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+        for (size_t thread_i = 0; thread_i < NUM_THREADS_PER_COMBINER; thread_i++) {
+            auto& my_latencies = latencies.at(combiner_i * NUM_THREADS_PER_COMBINER + thread_i);
+            threads.emplace_back([thread_i, combiner_i, &combiners, &my_latencies]() {
+                auto& my_combiner = combiners.at(combiner_i);
+                my_latencies.reserve(FAIRNESS_COUNT_PER_THREAD / LATENCY_SAMPLE_INTERVAL + 1);
+                for (uint64_t i = 0; i < FAIRNESS_COUNT_PER_THREAD; ++i) {
+                    if (i % LATENCY_SAMPLE_INTERVAL != 0) {
+                        my_combiner->getAndIncrement(thread_i);
+                        continue;
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    my_combiner->getAndIncrement(thread_i);
+                    auto end = std::chrono::steady_clock::now();
+                    my_latencies.push_back(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+                }
+            });
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::cout << "\n=== Fairness " << name << " ===\n";
+    std::cout << "| Thread | Mean (ns) | p50 (ns) | p99 (ns) | Max (ns) |\n"
+              << "|--------|-----------|----------|----------|----------|\n";
+    double sum_means = 0;
+    double sum_squared_means = 0;
+    uint64_t best_p99 = UINT64_MAX;
+    uint64_t worst_p99 = 0;
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        auto& samples = latencies[thread];
+        double mean = 0;
+        for (uint64_t sample : samples) {
+            mean += static_cast<double>(sample);
+        }
+        mean /= static_cast<double>(std::max<size_t>(samples.size(), 1));
+        sum_means += mean;
+        sum_squared_means += mean * mean;
+        uint64_t p50 = percentile(samples, 0.5);
+        uint64_t p99 = percentile(samples, 0.99);
+        uint64_t max = samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+        best_p99 = std::min(best_p99, p99);
+        worst_p99 = std::max(worst_p99, p99);
+        std::cout << std::format("| {}/{} | {:.0f} | {} | {} | {} |\n",
+                                 thread / NUM_THREADS_PER_COMBINER,
+                                 thread % NUM_THREADS_PER_COMBINER, mean, p50, p99, max);
+    }
+    // Jain's index: 1.0 if all threads see the same mean latency, 1/n if one thread sees all of it
+    double jain_index = (sum_means * sum_means) / (NUM_THREADS * sum_squared_means);
+    std::cout << std::format("Jain's fairness index (mean latency): {:.3f}\n", jain_index);
+    std::cout << std::format("Worst/best thread p99: {:.2f}x\n",
+                             static_cast<double>(worst_p99) /
+                                 static_cast<double>(std::max<uint64_t>(best_p99, 1)));
+}
+
+std::atomic<uint64_t> counter_priority{0};
+
+const size_t PRIORITY_COUNT_PER_THREAD = COUNT_PER_THREAD / 10;
+
+// Front-end for two classes of callers sharing one id space: latency-critical threads take their
+// number straight from the shared counter, bulk threads are batched through per-group combiners.
+// The foreground thereby never waits for a combining round, it only competes with one shared
+// fetch_add per bulk batch.
+template <size_t NUMBER, size_t GROUPS>
+class PrioritySequencer {
+    std::array<MultiRoundCombiner<NUMBER, counter_priority>, GROUPS> bulk_groups;
+
+   public:
+    uint64_t getAndIncrementHighPriority() {
+        return counter_priority.fetch_add(1);
+    }
+
+    uint64_t getAndIncrementBulk(size_t group, size_t my_id) {
+        return bulk_groups.at(group).getAndIncrement(my_id);
+    }
+
+    uint64_t current() const {
+        return counter_priority.load();
+    }
+
+    template <typename Deadline>
+    std::optional<uint64_t> tryGetAndIncrementHighPriority(const Deadline&) {
+        return getAndIncrementHighPriority();
+    }
+
+    template <typename Deadline>
+    std::optional<uint64_t> tryGetAndIncrementBulk(size_t group,
+                                                    size_t my_id,
+                                                    const Deadline& deadline) {
+        return bulk_groups.at(group).tryGetAndIncrement(my_id, deadline);
+    }
+};
+
+// Runs the first combiner group as foreground threads and the others as bulk threads, once with
+// every thread combining and once with priority lanes, and reports latency and throughput per
+// class.
+void casePriority() {
+    std::cout << "\n=== Priority Lanes ===\n";
+    std::cout << "| Configuration | Foreground p50 (ns) | Foreground p99 (ns) | "
+                 "Foreground (M ops/sec) | Bulk (M ops/sec) |\n"
+              << "|---------------|---------------------|---------------------|------------------"
+                 "------|------------------|\n";
+
+    for (bool priority_lanes : {false, true}) {
+        auto sequencer =
+            std::make_unique<PrioritySequencer<NUM_THREADS_PER_COMBINER, NUM_COMBINERS>>();
+        std::vector<std::thread> threads;
+        threads.reserve(NUM_THREADS);
+        std::vector<std::vector<uint64_t>> latencies(NUM_THREADS_PER_COMBINER);
+        std::vector<std::chrono::nanoseconds> durations(NUM_THREADS);
+
+        for (size_t combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+            for (size_t thread_i = 0; thread_i < NUM_THREADS_PER_COMBINER; thread_i++) {
+                bool foreground = combiner_i == 0;
+                auto& my_duration = durations.at(combiner_i * NUM_THREADS_PER_COMBINER + thread_i);
+                auto* my_latencies = foreground ? &latencies.at(thread_i) : nullptr;
+                threads.emplace_back([=, &sequencer, &my_duration]() {
+                    auto get_number = [&]() {
+                        if (foreground && priority_lanes) {
+                            return sequencer->getAndIncrementHighPriority();
+                        }
+                        return sequencer->getAndIncrementBulk(combiner_i, thread_i);
+                    };
+                    auto start_time = std::chrono::steady_clock::now();
+                    for (uint64_t i = 0; i < PRIORITY_COUNT_PER_THREAD; ++i) {
+                        if (!foreground || i % LATENCY_SAMPLE_INTERVAL != 0) {
+                            get_number();
+                            continue;
+                        }
+                        auto start = std::chrono::steady_clock::now();
+                        get_number();
+                        auto end = std::chrono::steady_clock::now();
+                        my_latencies->push_back(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+                                .count());
+                    }
+                    my_duration = std::chrono::steady_clock::now() - start_time;
+                });
+            }
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        std::vector<uint64_t> foreground_latencies;
+        for (auto& samples : latencies) {
+            foreground_latencies.insert(foreground_latencies.end(), samples.begin(), samples.end());
+        }
+        auto class_throughput = [&](size_t first_thread, size_t num_threads) {
+            auto slowest = *std::max_element(durations.begin() + first_thread,
+                                             durations.begin() + first_thread + num_threads);
+            return static_cast<double>(PRIORITY_COUNT_PER_THREAD * num_threads) /
+                   std::chrono::duration<double>(slowest).count();
+        };
+        double foreground_throughput = class_throughput(0, NUM_THREADS_PER_COMBINER);
+        double bulk_throughput =
+            class_throughput(NUM_THREADS_PER_COMBINER, NUM_THREADS - NUM_THREADS_PER_COMBINER);
+        uint64_t p50 = percentile(foreground_latencies, 0.5);
+        uint64_t p99 = percentile(foreground_latencies, 0.99);
+        std::cout << std::format("| {} | {} | {} | {:.2f} | {:.2f} |\n",
+                                 priority_lanes ? "Priority lanes" : "All combining", p50, p99,
+                                 foreground_throughput / 1000000, bulk_throughput / 1000000);
+    }
+}
+
+const size_t TRY_COUNT_PER_THREAD = COUNT_PER_THREAD / 10;
+const uint64_t TRY_BUDGET_CYCLES = 2000;
+const std::chrono::nanoseconds TRY_BUDGET_TIME{1000};
+const uint64_t EMERGENCY_LEASE_SIZE = 64;
+
+// Runs a latency-budgeted request loop: every thread asks the sequencer with a deadline and, when
+// the shared path does not answer in time, takes a number from a local emergency block that is
+// leased directly from the same counter.
+template <typename TryGetAndIncrement, typename MakeDeadline>
+void caseTryNextLine(const std::string& name,
+                     std::atomic<uint64_t>& counter,
+                     TryGetAndIncrement try_get_and_increment,
+                     MakeDeadline make_deadline) {
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::atomic<uint64_t> fallbacks{0};
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (size_t combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+        for (size_t thread_i = 0; thread_i < NUM_THREADS_PER_COMBINER; thread_i++) {
+            threads.emplace_back([=, &counter, &fallbacks]() {
+                uint64_t emergency_next = 0;
+                uint64_t emergency_end = 0;
+                uint64_t my_fallbacks = 0;
+                for (uint64_t i = 0; i < TRY_COUNT_PER_THREAD; ++i) {
+                    if (try_get_and_increment(combiner_i, thread_i, make_deadline())) {
+                        continue;
+                    }
+                    if (emergency_next == emergency_end) {
+                        emergency_next = counter.fetch_add(EMERGENCY_LEASE_SIZE);
+                        emergency_end = emergency_next + EMERGENCY_LEASE_SIZE;
+                    }
+                    emergency_next++;
+                    my_fallbacks++;
+                }
+                fallbacks += my_fallbacks;
+            });
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+    double total = static_cast<double>(TRY_COUNT_PER_THREAD * NUM_THREADS);
+    std::cout << std::format("| {} | {:.3f} | {:.2f} | {:.2f}% |\n", name, seconds.count(),
+                             total / seconds.count() / 1000000,
+                             100.0 * static_cast<double>(fallbacks.load()) / total);
+}
+
+template <typename MakeDeadline>
+void caseTryNext(const std::string& budget, MakeDeadline make_deadline) {
+    std::cout << "\n=== Deadline-bounded tryGetAndIncrement (" << budget << ") ===\n";
+    std::cout << "| Implementation | Duration | Throughput (M ops/sec) | Emergency fallbacks |\n"
+              << "|----------------|----------|------------------------|---------------------|\n";
+
+    caseTryNextLine(
+        "Lock", counter_lock,
+        [](size_t, size_t, const auto& deadline) { return tryGetAndIncrementLock(deadline); },
+        make_deadline);
+    caseTryNextLine(
+        "Simple CAS", counter_simple,
+        [](size_t, size_t, const auto& deadline) { return tryGetAndIncrementCas(deadline); },
+        make_deadline);
+
+    std::vector<std::unique_ptr<Combiner<NUM_THREADS_PER_COMBINER>>> combiners;
+    std::vector<std::unique_ptr<MultiRoundCombiner<NUM_THREADS_PER_COMBINER,
+                                                   counter_combiner_multi_round>>>
+        multi_round_combiners;
+    for (size_t combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+        combiners.emplace_back(std::make_unique<Combiner<NUM_THREADS_PER_COMBINER>>());
+        multi_round_combiners.emplace_back(
+            std::make_unique<MultiRoundCombiner<NUM_THREADS_PER_COMBINER,
+                                                counter_combiner_multi_round>>());
+    }
+    caseTryNextLine(
+        "Combiner", counter_combiner,
+        [&combiners](size_t combiner_i, size_t thread_i, const auto& deadline) {
+            return combiners[combiner_i]->tryGetAndIncrement(thread_i, deadline);
+        },
+        make_deadline);
+    caseTryNextLine(
+        "Multi-Round Combiner", counter_combiner_multi_round,
+        [&multi_round_combiners](size_t combiner_i, size_t thread_i, const auto& deadline) {
+            return multi_round_combiners[combiner_i]->tryGetAndIncrement(thread_i, deadline);
+        },
+        make_deadline);
+}
+
+// Counter for metrics rather than ids: adds go to the caller's own cache line and reads aggregate.
+// Values are not unique and a read is not linearizable with concurrent adds, which is what makes
+// add() as cheap as a thread-local increment.
+template <size_t SHARDS>
+class StatisticalCounter {
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+
+    std::array<Shard, SHARDS> shards;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> folded{0};
+
+   public:
+    // Every shard has a single writer, so a relaxed load/store pair replaces the locked RMW.
+    void add(size_t shard, uint64_t amount) {
+        auto& value = shards.at(shard).value;
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    // Sums all shards. Each shard is read at a different time, but the result never goes
+    // backwards and is exact once writers are quiescent.
+    uint64_t read() const {
+        uint64_t sum = 0;
+        for (const auto& shard : shards) {
+            sum += shard.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+    // Publishes the current sum for readApproximate. Meant to be called periodically by one
+    // thread, so that frequent readers share one cache line instead of pulling every shard.
+    void fold() {
+        folded.store(read(), std::memory_order_relaxed);
+    }
+
+    // The sum as of the last fold, a single load.
+    uint64_t readApproximate() const {
+        return folded.load(std::memory_order_relaxed);
+    }
+};
+
+const size_t STATISTICAL_COUNT_PER_THREAD = COUNT_PER_THREAD / 10;
+const std::chrono::milliseconds STATISTICAL_FOLD_INTERVAL{1};
+
+// Each thread adds 1 per operation and reads instead for read_percent out of every 100.
+template <typename Add, typename Read>
+void caseStatisticalCounterLine(const std::string& name, size_t read_percent, Add add, Read read) {
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::atomic<uint64_t> total{0};
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (size_t thread_i = 0; thread_i < NUM_THREADS; thread_i++) {
+        threads.emplace_back([=, &total]() {
+            uint64_t my_total = 0;
+            for (uint64_t i = 0; i < STATISTICAL_COUNT_PER_THREAD; ++i) {
+                if (i % 100 < read_percent) {
+                    my_total += read();
+                } else {
+                    add(thread_i);
+                }
+            }
+            total += my_total;
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+    double operations = static_cast<double>(STATISTICAL_COUNT_PER_THREAD * NUM_THREADS);
+    std::cout << std::format("| {} | {}% | {:.3f} | {:.2f} |\n", name, read_percent,
+                             seconds.count(), operations / seconds.count() / 1000000);
+}
+
+void caseStatisticalCounter() {
+    std::cout << "\n=== Statistical Counter ===\n";
+    std::cout << "| Implementation | Reads | Duration | Throughput (M ops/sec) |\n"
+              << "|----------------|-------|----------|------------------------|\n";
+
+    for (size_t read_percent : {0, 1, 10, 50}) {
+        std::atomic<uint64_t> shared{0};
+        caseStatisticalCounterLine(
+            "Single atomic", read_percent, [&shared](size_t) { shared.fetch_add(1); },
+            [&shared]() { return shared.load(); });
+
+        auto sum_on_read = std::make_unique<StatisticalCounter<NUM_THREADS>>();
+        caseStatisticalCounterLine(
+            "Sharded, sum on read", read_percent,
+            [&sum_on_read](size_t thread_i) { sum_on_read->add(thread_i, 1); },
+            [&sum_on_read]() { return sum_on_read->read(); });
+
+        auto folding = std::make_unique<StatisticalCounter<NUM_THREADS>>();
+        std::atomic<bool> stop_folding{false};
+        std::thread folder([&folding, &stop_folding]() {
+            while (!stop_folding) {
+                folding->fold();
+                std::this_thread::sleep_for(STATISTICAL_FOLD_INTERVAL);
+            }
+        });
+        caseStatisticalCounterLine(
+            "Sharded, periodic fold", read_percent,
+            [&folding](size_t thread_i) { folding->add(thread_i, 1); },
+            [&folding]() { return folding->readApproximate(); });
+        stop_folding = true;
+        folder.join();
+    }
+}
+
+std::atomic<uint64_t> counter_relaxed{0};
+
+// Issues unique numbers with a bounded out-of-order distance k: no number is issued after a number
+// more than k greater has been issued. Threads take numbers from private leases of adaptive size.
+// Since every number issued so far is below the shared counter, a leased number is still safe to
+// issue as long as the counter has not run more than k past it; otherwise the rest of the lease
+// is dropped (leaving gaps) and the next lease is smaller.
+template <size_t NUMBER>
+class RelaxedSequencer {
+    struct alignas(CACHE_LINE_SIZE) Lease {
+        uint64_t next = 0;
+        uint64_t end = 0;
+        uint64_t size = 1;
+        uint64_t dropped = 0;
+    };
+
+    std::array<Lease, NUMBER> leases;
+    uint64_t k;
+    StatsCounters stats_counters;
+
+   public:
+    explicit RelaxedSequencer(uint64_t k)
+        : k(k) {}
+
+    uint64_t getAndIncrement(size_t my_id) {
+        stats_counters.add(Stat::OPERATIONS);
+        auto& lease = leases.at(my_id);
+        while (true) {
+            if (lease.next < lease.end) {
+                uint64_t largest_allocated = counter_relaxed.load() - 1;
+                if (largest_allocated - lease.next <= k) {
+                    return lease.next++;
+                }
+                stats_counters.add(Stat::FALLBACKS);
+                lease.dropped += lease.end - lease.next;
+                lease.size = std::max<uint64_t>(1, lease.size / 2);
+            } else if (lease.end != 0) {
+                // a lease used up completely may grow, but never beyond what k allows at all
+                lease.size = std::min(k + 1, lease.size * 2);
+            }
+            SEQUENCER_PROBE2(lease_refill, this, lease.size);
+            stats_counters.add(Stat::LEASE_REFILLS);
+            stats_counters.add(Stat::SHARED_RMWS);
+            lease.next = counter_relaxed.fetch_add(lease.size);
+            lease.end = lease.next + lease.size;
+        }
+    }
+
+    // Every number issued so far is below it; numbers in unused leases are as well.
+    uint64_t current() const {
+        return counter_relaxed.load();
+    }
+
+    // Gives up the lease of my_id so the slot can go to another thread, which starts with a fresh
+    // lease. Returns the leased numbers that will never be issued; they count as dropped.
+    uint64_t retire(size_t my_id) {
+        auto& lease = leases.at(my_id);
+        uint64_t unissued = lease.end - lease.next;
+        lease.dropped += unissued;
+        lease.next = 0;
+        lease.end = 0;
+        lease.size = 1;
+        return unissued;
+    }
+
+    // Slots still holding a lease, i.e. used and not retired since.
+    size_t unretiredLeases() const {
+        return std::count_if(leases.begin(), leases.end(),
+                             [](const Lease& lease) { return lease.end != 0; });
+    }
+
+    // Numbers that were leased but dropped because they fell more than k behind.
+    uint64_t droppedNumbers() const {
+        uint64_t dropped = 0;
+        for (const auto& lease : leases) {
+            dropped += lease.dropped;
+        }
+        return dropped;
+    }
+
+    // Fallbacks are leases dropped for falling more than k behind.
+    SequencerStats stats() const {
+        return stats_counters.read();
+    }
+};
+
+const size_t RELAXED_COUNT_PER_THREAD = COUNT_PER_THREAD / 10;
+const size_t RELAXED_VERIFY_COUNT_PER_THREAD = COUNT_PER_THREAD / 100;
+
+void atomicFetchMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load();
+    while (current < value && !target.compare_exchange_weak(current, value)) {
+    }
+}
+
+// Runs the k-relaxed sequencer once for throughput and once with verification: before every call
+// a thread reads the largest number issued so far (published after each call), and the number it
+// gets must not be more than k below that.
+void caseRelaxed() {
+    std::cout << "\n=== k-Relaxed Sequencer ===\n";
+    std::cout << "| k | Duration | Throughput (M ops/sec) | Dropped numbers | Max distance | "
+                 "Violations |\n"
+              << "|---|----------|------------------------|-----------------|--------------|"
+                 "------------|\n";
+
+    for (uint64_t k : {0, 16, 256, 4096}) {
+        auto sequencer = std::make_unique<RelaxedSequencer<NUM_THREADS>>(k);
+        std::vector<std::thread> threads;
+        threads.reserve(NUM_THREADS);
+        auto start_time = std::chrono::steady_clock::now();
+        for (size_t thread_i = 0; thread_i < NUM_THREADS; thread_i++) {
+            threads.emplace_back([thread_i, &sequencer]() {
+                for (uint64_t i = 0; i < RELAXED_COUNT_PER_THREAD; ++i) {
+                    sequencer->getAndIncrement(thread_i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+
+        auto verified = std::make_unique<RelaxedSequencer<NUM_THREADS>>(k);
+        std::atomic<uint64_t> largest_issued{0};
+        std::atomic<uint64_t> max_distance{0};
+        std::atomic<uint64_t> violations{0};
+        threads.clear();
+        for (size_t thread_i = 0; thread_i < NUM_THREADS; thread_i++) {
+            threads.emplace_back([=, &verified, &largest_issued, &max_distance, &violations]() {
+                uint64_t my_max_distance = 0;
+                uint64_t my_violations = 0;
+                for (uint64_t i = 0; i < RELAXED_VERIFY_COUNT_PER_THREAD; ++i) {
+                    uint64_t largest_before = largest_issued.load();
+                    uint64_t number = verified->getAndIncrement(thread_i);
+                    if (largest_before > number) {
+                        my_max_distance = std::max(my_max_distance, largest_before - number);
+                        my_violations += largest_before - number > k ? 1 : 0;
+                    } else {
+                        atomicFetchMax(largest_issued, number);
+                    }
+                }
+                atomicFetchMax(max_distance, my_max_distance);
+                violations += my_violations;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        double operations = static_cast<double>(RELAXED_COUNT_PER_THREAD * NUM_THREADS);
+        std::cout << std::format("| {} | {:.3f} | {:.2f} | {} | {} | {} |\n", k, seconds.count(),
+                                 operations / seconds.count() / 1000000,
+                                 sequencer->droppedNumbers(), max_distance.load(),
+                                 violations.load());
+    }
+}
+
+// (epoch, sequence) pair, ordered like the sequencer issued them.
+struct EpochSequenceNumber {
+    uint64_t epoch;
+    uint64_t sequence;
+
+    auto operator<=>(const EpochSequenceNumber&) const = default;
+};
+
+// Issues (epoch, sequence) pairs for streams whose sequence numbers are narrow and wrap. Both
+// live in one 64-bit word with the sequence in the low SEQUENCE_BITS, so the packed value orders
+// pairs lexicographically and a plain fetch_add carries a wrapping sequence into the epoch: wrap
+// handling costs nothing over a 64-bit fetch_add and needs neither a lock nor a 16-byte CAS. An
+// administrative reset starts the next epoch with a CAS. The epoch itself wraps after
+// 2^(64 - SEQUENCE_BITS) epochs.
+template <size_t SEQUENCE_BITS>
+class EpochSequencer {
+    static_assert(SEQUENCE_BITS > 0 && SEQUENCE_BITS < 64);
+    static constexpr uint64_t SEQUENCE_MASK = (uint64_t{1} << SEQUENCE_BITS) - 1;
+
+    std::atomic<uint64_t> packed{0};
+
+    static EpochSequenceNumber unpack(uint64_t value) {
+        return EpochSequenceNumber{value >> SEQUENCE_BITS, value & SEQUENCE_MASK};
+    }
+
+   public:
+    EpochSequenceNumber getAndIncrement() {
+        return unpack(packed.fetch_add(1));
+    }
+
+    // The next pair to be issued.
+    EpochSequenceNumber current() const {
+        return unpack(packed.load());
+    }
+
+    // Starts a new epoch at sequence 0 and returns it.
+    uint64_t resetEpoch() {
+        uint64_t current = packed.load();
+        uint64_t next;
+        do {
+            next = ((current >> SEQUENCE_BITS) + 1) << SEQUENCE_BITS;
+        } while (!packed.compare_exchange_weak(current, next));
+        return next >> SEQUENCE_BITS;
+    }
+};
+
+const size_t EPOCH_COUNT_PER_THREAD = COUNT_PER_THREAD / 10;
+const std::chrono::milliseconds EPOCH_RESET_INTERVAL{1};
+
+// Each thread checks that the pairs it receives strictly increase.
+template <typename GetAndIncrement>
+void caseEpochLine(const std::string& name, GetAndIncrement get_and_increment) {
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::atomic<uint64_t> order_violations{0};
+    std::atomic<uint64_t> last_epoch{0};
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (size_t thread_i = 0; thread_i < NUM_THREADS; thread_i++) {
+        threads.emplace_back([&]() {
+            uint64_t my_order_violations = 0;
+            EpochSequenceNumber previous = get_and_increment();
+            for (uint64_t i = 1; i < EPOCH_COUNT_PER_THREAD; ++i) {
+                EpochSequenceNumber current = get_and_increment();
+                my_order_violations += current <= previous ? 1 : 0;
+                previous = current;
+            }
+            order_violations += my_order_violations;
+            atomicFetchMax(last_epoch, previous.epoch);
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+    double operations = static_cast<double>(EPOCH_COUNT_PER_THREAD * NUM_THREADS);
+    std::cout << std::format("| {} | {:.3f} | {:.2f} | {} | {} |\n", name, seconds.count(),
+                             operations / seconds.count() / 1000000, last_epoch.load(),
+                             order_violations.load());
+}
+
+void caseEpoch() {
+    std::cout << "\n=== Epoch Sequencer ===\n";
+    std::cout << "| Implementation | Duration | Throughput (M ops/sec) | Last epoch | "
+                 "Order violations |\n"
+              << "|----------------|----------|------------------------|------------|"
+                 "------------------|\n";
+
+    std::atomic<uint64_t> plain{0};
+    caseEpochLine("64-bit fetch_add", [&plain]() {
+        return EpochSequenceNumber{0, plain.fetch_add(1)};
+    });
+
+    EpochSequencer<32> epoch_32;
+    caseEpochLine("Epoch, 32-bit sequence", [&epoch_32]() { return epoch_32.getAndIncrement(); });
+
+    // small enough to wrap many times during the run
+    EpochSequencer<12> epoch_12;
+    caseEpochLine("Epoch, 12-bit sequence", [&epoch_12]() { return epoch_12.getAndIncrement(); });
+
+    EpochSequencer<32> epoch_resets;
+    std::atomic<bool> stop_resets{false};
+    std::thread resetter([&epoch_resets, &stop_resets]() {
+        while (!stop_resets) {
+            std::this_thread::sleep_for(EPOCH_RESET_INTERVAL);
+            epoch_resets.resetEpoch();
+        }
+    });
+    caseEpochLine("Epoch, 32-bit sequence, periodic resets",
+                  [&epoch_resets]() { return epoch_resets.getAndIncrement(); });
+    stop_resets = true;
+    resetter.join();
+}
+
+const size_t SNAPSHOT_COUNT_PER_THREAD = COUNT_PER_THREAD / 10;
+
+// The last readers_per_group threads of every combiner group poll a snapshot until the others are
+// done incrementing. Reports the writers' throughput next to the readers' poll rate.
+template <typename GetAndIncrement, typename Snapshot>
+void caseSnapshotLine(const std::string& name,
+                      size_t readers_per_group,
+                      GetAndIncrement get_and_increment,
+                      Snapshot snapshot) {
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::atomic<size_t> writers_running{NUM_COMBINERS *
+                                        (NUM_THREADS_PER_COMBINER - readers_per_group)};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> checksum{0};
+
+    auto start_time = std::chrono::steady_clock::now();
+    std::atomic<int64_t> writers_end_ns{0};
+
+    for (size_t combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+        for (size_t thread_i = 0; thread_i < NUM_THREADS_PER_COMBINER; thread_i++) {
+            bool reader = thread_i >= NUM_THREADS_PER_COMBINER - readers_per_group;
+            threads.emplace_back([=, &writers_running, &reads, &checksum, &writers_end_ns]() {
+                uint64_t my_checksum = 0;
+                if (reader) {
+                    uint64_t my_reads = 0;
+                    while (writers_running.load(std::memory_order_relaxed) > 0) {
+                        my_checksum += snapshot(combiner_i);
+                        my_reads++;
+                    }
+                    reads += my_reads;
+                } else {
+                    for (uint64_t i = 0; i < SNAPSHOT_COUNT_PER_THREAD; ++i) {
+                        my_checksum += get_and_increment(combiner_i, thread_i);
+                    }
+                    if (--writers_running == 0) {
+                        writers_end_ns = (std::chrono::steady_clock::now() - start_time).count();
+                    }
+                }
+                checksum += my_checksum;
+            });
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double seconds = static_cast<double>(writers_end_ns.load()) / 1e9;
+    size_t writers = NUM_COMBINERS * (NUM_THREADS_PER_COMBINER - readers_per_group);
+    double operations = static_cast<double>(SNAPSHOT_COUNT_PER_THREAD * writers);
+    std::cout << std::format("| {} | {} | {:.2f} | {:.2f} |\n", name,
+                             readers_per_group * NUM_COMBINERS,
+                             operations / seconds / 1000000,
+                             static_cast<double>(reads.load()) / seconds / 1000000);
+}
+
+// Compares monitoring reads of the shared counter (current) with reads of a published copy
+// (lowerBound) while the sequencers are under load.
+void caseSnapshot() {
+    std::cout << "\n=== Snapshot Reads ===\n";
+    std::cout << "| Implementation | Readers | Increments (M ops/sec) | Reads (M ops/sec) |\n"
+              << "|----------------|---------|------------------------|-------------------|\n";
+
+    for (size_t readers_per_group : {0, 1, 2}) {
+        caseSnapshotLine(
+            "Simple CAS, current", readers_per_group,
+            [](size_t, size_t) { return getAndIncrementCas(); },
+            [](size_t) { return currentCas(); });
+        caseSnapshotLine(
+            "Lock, current", readers_per_group,
+            [](size_t, size_t) { return getAndIncrementLock(); },
+            [](size_t) { return currentLock(); });
+
+        for (bool lower_bound : {false, true}) {
+            std::vector<std::unique_ptr<Combiner<NUM_THREADS_PER_COMBINER>>> combiners;
+            for (size_t combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+                combiners.emplace_back(std::make_unique<Combiner<NUM_THREADS_PER_COMBINER>>());
+            }
+            caseSnapshotLine(
+                lower_bound ? "Combiner, lowerBound" : "Combiner, current", readers_per_group,
+                [&combiners](size_t combiner_i, size_t thread_i) {
+                    return combiners[combiner_i]->getAndIncrement(thread_i);
+                },
+                [&combiners, lower_bound](size_t combiner_i) {
+                    return lower_bound ? combiners[combiner_i]->lowerBound()
+                                       : combiners[combiner_i]->current();
+                });
+        }
+
+        for (bool lower_bound : {false, true}) {
+            StackCombiner combiner;
+            caseSnapshotLine(
+                lower_bound ? "Stack Combiner, lowerBound" : "Stack Combiner, current",
+                readers_per_group,
+                [&combiner](size_t, size_t) { return combiner.getAndIncrement(); },
+                [&combiner, lower_bound](size_t) {
+                    return lower_bound ? combiner.lowerBound() : combiner.current();
+                });
+        }
+    }
+}
+
+// Sequencer choice and parameters for this host, as found by the tuner and loaded at startup.
+struct SequencerConfig {
+    // one of SEQUENCER_STRATEGIES
+    std::string strategy = "combiner";
+    // threads sharing one combiner
+    size_t group_size = NUM_THREADS_PER_COMBINER;
+    // rounds per combiner turn (multi-round, fair, snzi, stack)
+    size_t max_rounds = MULTI_ROUND_MAX_ROUNDS;
+    // time budget per combiner turn (multi-round, fair, snzi)
+    uint64_t time_budget_ns = MULTI_ROUND_TIME_BUDGET.count();
+    // SNZI tree fanout: threads per leaf
+    size_t snzi_threads_per_leaf = SNZI_THREADS_PER_LEAF;
+    // backoff constant of spinWait
+    size_t spins_before_yield = SPINS_BEFORE_YIELD;
+    // "spin" (pause, yield every spins_before_yield) or "yield"
+    std::string wait_strategy = "spin";
+};
+
+const std::string TUNING_CONFIG_PATH = "sequencer_tuning.conf";
+const std::array<std::string_view, 7> SEQUENCER_STRATEGIES = {
+    "cas", "lock", "combiner", "multi-round", "fair", "snzi", "stack"};
+// the values withGroupSize and measureConfig instantiate
+const std::array<size_t, 5> SEQUENCER_GROUP_SIZES = {1, 2, 4, 8, 16};
+const std::array<size_t, 3> SEQUENCER_SNZI_FANOUTS = {1, 2, 4};
+
+std::string describe(const SequencerConfig& config) {
+    return std::format("{} group={} rounds={} budget={}ns fanout={} spins={} wait={}",
+                       config.strategy, config.group_size, config.max_rounds,
+                       config.time_budget_ns, config.snzi_threads_per_leaf,
+                       config.spins_before_yield, config.wait_strategy);
+}
+
+void writeSequencerConfig(const SequencerConfig& config, const std::string& path) {
+    std::ofstream stream(path);
+    stream << "# written by the sequencer tuner for this host\n"
+           << "strategy=" << config.strategy << "\n"
+           << "group_size=" << config.group_size << "\n"
+           << "max_rounds=" << config.max_rounds << "\n"
+           << "time_budget_ns=" << config.time_budget_ns << "\n"
+           << "snzi_threads_per_leaf=" << config.snzi_threads_per_leaf << "\n"
+           << "spins_before_yield=" << config.spins_before_yield << "\n"
+           << "wait_strategy=" << config.wait_strategy << "\n";
+}
+
+// The whole of text as an unsigned decimal number, empty if it is anything else.
+std::optional<uint64_t> parseUint64(std::string_view text) {
+    uint64_t value;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// The whole of text as a floating-point number, empty if it is anything else.
+std::optional<double> parseDouble(const std::string& text) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (text.empty() || end != text.c_str() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// Reads a key=value file as written by writeSequencerConfig. Unknown keys and malformed numbers
+// are reported and skipped, missing keys keep their defaults. Empty if the file cannot be opened
+// or names an unknown strategy, group size or SNZI fanout.
+std::optional<SequencerConfig> loadSequencerConfig(const std::string& path) {
+    std::ifstream stream(path);
+    if (!stream) {
+        return std::nullopt;
+    }
+    SequencerConfig config;
+    std::string line;
+    while (std::getline(stream, line)) {
+        size_t separator = line.find('=');
+        if (line.empty() || line.front() == '#' || separator == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, separator);
+        std::string value = line.substr(separator + 1);
+        auto set_number = [&line, &path, &value](auto& field) {
+            if (std::optional<uint64_t> number = parseUint64(value)) {
+                field = *number;
+            } else {
+                std::cerr << "Ignoring malformed line '" << line << "' in " << path << "\n";
+            }
+        };
+        if (key == "strategy") {
+            config.strategy = value;
+        } else if (key == "group_size") {
+            set_number(config.group_size);
+        } else if (key == "max_rounds") {
+            set_number(config.max_rounds);
+        } else if (key == "time_budget_ns") {
+            set_number(config.time_budget_ns);
+        } else if (key == "snzi_threads_per_leaf") {
+            set_number(config.snzi_threads_per_leaf);
+        } else if (key == "spins_before_yield") {
+            set_number(config.spins_before_yield);
+        } else if (key == "wait_strategy") {
+            config.wait_strategy = value;
+        } else {
+            std::cerr << "Ignoring unknown key '" << key << "' in " << path << "\n";
+        }
+    }
+    if (std::find(SEQUENCER_STRATEGIES.begin(), SEQUENCER_STRATEGIES.end(), config.strategy) ==
+        SEQUENCER_STRATEGIES.end()) {
+        std::cerr << "Unknown strategy '" << config.strategy << "' in " << path
+                  << ", not running the tuned configuration\n";
+        return std::nullopt;
+    }
+    auto supported = [&path](const auto& values, size_t value, const std::string& key) {
+        if (std::find(values.begin(), values.end(), value) != values.end()) {
+            return true;
+        }
+        std::cerr << "Unsupported " << key << " " << value << " in " << path
+                  << ", not running the tuned configuration\n";
+        return false;
+    };
+    if (!supported(SEQUENCER_GROUP_SIZES, config.group_size, "group_size") ||
+        !supported(SEQUENCER_SNZI_FANOUTS, config.snzi_threads_per_leaf,
+                   "snzi_threads_per_leaf")) {
+        return std::nullopt;
+    }
+    return config;
+}
+
+// Applies the process-wide wait parameters. Must not be called while sequencers are in use.
+void applySequencerConfig(const SequencerConfig& config) {
+    spins_before_yield = std::max<size_t>(1, config.spins_before_yield);
+    yield_while_waiting = config.wait_strategy == "yield";
+}
+
+// Calls function with the group size as a compile-time constant.
+template <typename Function>
+auto withGroupSize(size_t group_size, Function function) {
+    switch (group_size) {
+        case 1:
+            return function(std::integral_constant<size_t, 1>{});
+        case 2:
+            return function(std::integral_constant<size_t, 2>{});
+        case 8:
+            return function(std::integral_constant<size_t, 8>{});
+        case 16:
+            return function(std::integral_constant<size_t, 16>{});
+        default:
+            return function(std::integral_constant<size_t, NUM_THREADS_PER_COMBINER>{});
+    }
+}
+
+struct TuneMeasurement {
+    std::chrono::nanoseconds duration;
+    double throughput;
+    uint64_t p99_ns;
+};
+
+// Runs NUM_THREADS threads in groups of group_size and samples latency like the fairness case.
+template <typename GetAndIncrement>
+TuneMeasurement measureGroups(size_t group_size,
+                              uint64_t count_per_thread,
+                              GetAndIncrement get_and_increment) {
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::vector<std::vector<uint64_t>> latencies(NUM_THREADS);
+
+    auto start_time = std::chrono::steady_clock::now();
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        threads.emplace_back([=, &latencies, &get_and_increment]() {
+            auto& my_latencies = latencies[thread];
+            for (uint64_t i = 0; i < count_per_thread; ++i) {
+                if (i % LATENCY_SAMPLE_INTERVAL != 0) {
+                    get_and_increment(thread / group_size, thread % group_size);
+                    countCompleted(i);
+                    continue;
+                }
+                auto start = std::chrono::steady_clock::now();
+                get_and_increment(thread / group_size, thread % group_size);
+                auto end = std::chrono::steady_clock::now();
+                countCompleted(i);
+                my_latencies.push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto duration = std::chrono::steady_clock::now() - start_time;
+
+    std::vector<uint64_t> all_latencies;
+    for (auto& samples : latencies) {
+        all_latencies.insert(all_latencies.end(), samples.begin(), samples.end());
+    }
+    return TuneMeasurement{
+        duration,
+        static_cast<double>(count_per_thread * NUM_THREADS) /
+            std::chrono::duration<double>(duration).count(),
+        percentile(all_latencies, 0.99)};
+}
+
+template <typename CombinerType, typename... Args>
+TuneMeasurement measureCombiner(size_t group_size, uint64_t count_per_thread, const Args&... args) {
+    std::vector<std::unique_ptr<CombinerType>> combiners;
+    for (size_t group = 0; group < NUM_THREADS / group_size; group++) {
+        combiners.emplace_back(std::make_unique<CombinerType>(args...));
+    }
+    return measureGroups(group_size, count_per_thread,
+                         [&combiners](size_t group, size_t my_id) {
+                             return combiners[group]->getAndIncrement(my_id);
+                         });
+}
+
+// config.strategy, group_size and snzi_threads_per_leaf must be among the supported values, as
+// loadSequencerConfig ensures.
+TuneMeasurement measureConfig(const SequencerConfig& config, uint64_t count_per_thread) {
+    applySequencerConfig(config);
+    std::chrono::nanoseconds time_budget{config.time_budget_ns};
+    if (config.strategy == "cas") {
+        return measureGroups(1, count_per_thread,
+                             [](size_t, size_t) { return getAndIncrementCas(); });
+    }
+    if (config.strategy == "lock") {
+        return measureGroups(1, count_per_thread,
+                             [](size_t, size_t) { return getAndIncrementLock(); });
+    }
+    if (config.strategy == "stack") {
+        StackCombiner combiner(std::max<size_t>(2, config.max_rounds));
+        return measureGroups(1, count_per_thread,
+                             [&combiner](size_t, size_t) { return combiner.getAndIncrement(); });
+    }
+    return withGroupSize(config.group_size, [&](auto group_size) {
+        constexpr size_t N = decltype(group_size)::value;
+        if (config.strategy == "multi-round") {
+            return measureCombiner<MultiRoundCombiner<N, counter_combiner_multi_round>>(
+                N, count_per_thread, config.max_rounds, time_budget);
+        }
+        if (config.strategy == "fair") {
+            return measureCombiner<FairCombiner<N>>(N, count_per_thread, config.max_rounds,
+                                                    time_budget);
+        }
+        if (config.strategy == "snzi") {
+            switch (config.snzi_threads_per_leaf) {
+                case 1:
+                    return measureCombiner<SnziCombiner<N, 1>>(N, count_per_thread,
+                                                               config.max_rounds, time_budget);
+                case 4:
+                    return measureCombiner<SnziCombiner<N, 4>>(N, count_per_thread,
+                                                               config.max_rounds, time_budget);
+                default:
+                    return measureCombiner<SnziCombiner<N, 2>>(N, count_per_thread,
+                                                               config.max_rounds, time_budget);
+            }
+        }
+        return measureCombiner<Combiner<N>>(N, count_per_thread);
+    });
+}
+
+const size_t TUNE_CANDIDATES = 32;
+const uint64_t TUNE_INITIAL_COUNT_PER_THREAD = COUNT_PER_THREAD / 1000;
+const uint64_t TUNE_P99_LIMIT_NS = 100000;
+
+// Samples TUNE_CANDIDATES configurations (plus the plain CAS and lock baselines) and runs
+// successive halving: every round measures all remaining candidates with twice the operations of
+// the previous round and keeps the faster half. Candidates over the p99 limit rank behind all
+// others. The winner is written to config_path.
+void runTuner(const std::string& config_path) {
+    std::vector<std::string> strategies = {"combiner", "multi-round", "fair", "snzi", "stack"};
+    std::vector<size_t> group_sizes = {2, 4, 8, 16};
+    std::vector<size_t> max_rounds = {2, 4, 16, 64};
+    std::vector<uint64_t> time_budgets_ns = {500, 2000, 8000};
+    std::vector<size_t> fanouts = {1, 2, 4};
+    std::vector<size_t> spins = {16, 128, 1024};
+    std::vector<std::string> wait_strategies = {"spin", "yield"};
+
+    std::mt19937 random(std::random_device{}());
+    auto pick = [&random](const auto& values) {
+        return values[std::uniform_int_distribution<size_t>(0, values.size() - 1)(random)];
+    };
+    std::vector<SequencerConfig> candidates(2);
+    candidates[0].strategy = "cas";
+    candidates[1].strategy = "lock";
+    while (candidates.size() < TUNE_CANDIDATES + 2) {
+        SequencerConfig config;
+        config.strategy = pick(strategies);
+        config.group_size = pick(group_sizes);
+        config.max_rounds = pick(max_rounds);
+        config.time_budget_ns = pick(time_budgets_ns);
+        config.snzi_threads_per_leaf = pick(fanouts);
+        config.spins_before_yield = pick(spins);
+        config.wait_strategy = pick(wait_strategies);
+        candidates.push_back(config);
+    }
+
+    std::cout << "\n=== Tuning (p99 limit " << TUNE_P99_LIMIT_NS << " ns) ===\n";
+    uint64_t count_per_thread = TUNE_INITIAL_COUNT_PER_THREAD;
+    for (size_t round = 0; candidates.size() > 1; round++, count_per_thread *= 2) {
+        std::vector<std::pair<TuneMeasurement, SequencerConfig>> measured;
+        for (const auto& config : candidates) {
+            measured.emplace_back(measureConfig(config, count_per_thread), config);
+        }
+        std::sort(measured.begin(), measured.end(), [](const auto& a, const auto& b) {
+            bool a_ok = a.first.p99_ns <= TUNE_P99_LIMIT_NS;
+            bool b_ok = b.first.p99_ns <= TUNE_P99_LIMIT_NS;
+            if (a_ok != b_ok) {
+                return a_ok;
+            }
+            return a.first.throughput > b.first.throughput;
+        });
+        std::cout << std::format("Round {} ({} ops/thread): best {:.2f} M ops/sec, p99 {} ns: {}\n",
+                                 round, count_per_thread, measured.front().first.throughput / 1e6,
+                                 measured.front().first.p99_ns, describe(measured.front().second));
+        candidates.clear();
+        for (size_t i = 0; i < (measured.size() + 1) / 2; i++) {
+            candidates.push_back(measured[i].second);
+        }
+    }
+    applySequencerConfig(SequencerConfig{});
+
+    writeSequencerConfig(candidates.front(), config_path);
+    std::cout << "Winner: " << describe(candidates.front()) << "\n";
+    std::cout << "Written to " << config_path << "\n";
+}
+
+// Two cpus of the same physical core, if SMT is enabled.
+std::optional<std::pair<int, int>> findSmtSiblings() {
+    int num_cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int cpu = 0; cpu < num_cpus; cpu++) {
+        auto siblings = parseCpuList(readCpuSysfs(cpu, "topology/thread_siblings_list"));
+        if (siblings.size() >= 2) {
+            return std::make_pair(siblings[0], siblings[1]);
+        }
+    }
+    return std::nullopt;
+}
+
+// Two cpus in different sockets, if there is more than one.
+std::optional<std::pair<int, int>> findCrossSocketPair() {
+    int num_cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string first_package = readCpuSysfs(0, "topology/physical_package_id");
+    for (int cpu = 1; cpu < num_cpus && !first_package.empty(); cpu++) {
+        std::string package = readCpuSysfs(cpu, "topology/physical_package_id");
+        if (!package.empty() && package != first_package) {
+            return std::make_pair(0, cpu);
+        }
+    }
+    return std::nullopt;
+}
+
+const uint64_t UNCONTENDED_WARMUP_OPS = 10000;
+const uint64_t UNCONTENDED_OPS = COUNT_PER_THREAD / 10;
+
+// Runs one thread per given cpu (pinned) through a fenced timing loop on a fresh sequencer and
+// returns "ns/op | cycles/op" averaged over the threads.
+template <typename MakeSequencer>
+std::string measureUncontended(MakeSequencer make_sequencer, const std::vector<int>& cpus) {
+    auto get_and_increment = make_sequencer();
+    std::vector<std::thread> threads;
+    std::atomic<size_t> ready{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> total_cycles{0};
+    std::atomic<uint64_t> sink{0};
+    for (size_t my_id = 0; my_id < cpus.size(); my_id++) {
+        threads.emplace_back([&, my_id, cpu = cpus[my_id]]() {
+            pinCurrentThread(cpu);
+            uint64_t my_sink = 0;
+            for (uint64_t i = 0; i < UNCONTENDED_WARMUP_OPS; ++i) {
+                my_sink += get_and_increment(my_id);
+            }
+            // start the timed loops together
+            ready++;
+            while (ready.load() < cpus.size()) {
+                cpuRelax();
+            }
+            auto start_time = std::chrono::steady_clock::now();
+            uint64_t start_cycles = readCyclesStart();
+            for (uint64_t i = 0; i < UNCONTENDED_OPS; ++i) {
+                my_sink += get_and_increment(my_id);
+            }
+            uint64_t end_cycles = readCyclesEnd();
+            auto end_time = std::chrono::steady_clock::now();
+            total_cycles += end_cycles - start_cycles;
+            total_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time)
+                            .count();
+            sink += my_sink;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double operations = static_cast<double>(UNCONTENDED_OPS * cpus.size());
+    return std::format("{:.1f} | {:.1f}", static_cast<double>(total_ns.load()) / operations,
+                       static_cast<double>(total_cycles.load()) / operations);
+}
+
+template <typename MakeSequencer>
+void caseUncontendedLine(const std::string& name,
+                         MakeSequencer make_sequencer,
+                         const std::optional<std::pair<int, int>>& smt_siblings,
+                         const std::optional<std::pair<int, int>>& cross_socket) {
+    auto pair = [&](const std::optional<std::pair<int, int>>& cpus) {
+        return cpus ? measureUncontended(make_sequencer, {cpus->first, cpus->second})
+                    : std::string("n/a | n/a");
+    };
+    std::string single = measureUncontended(make_sequencer, {0});
+    std::string siblings = pair(smt_siblings);
+    std::string sockets = pair(cross_socket);
+    std::cout << std::format("| {} | {} | {} | {} |\n", name, single, siblings, sockets);
+}
+
+// Fast-path cost of each sequencer: one thread alone, and two threads on SMT siblings or on
+// different sockets. Cycles are TSC cycles on x86 and generic timer ticks on arm64.
+void caseUncontended() {
+    auto smt_siblings = findSmtSiblings();
+    auto cross_socket = findCrossSocketPair();
+    std::cout << "\n=== Uncontended Latency ===\n";
+    std::cout << "SMT siblings: "
+              << (smt_siblings ? std::format("cpu {} + {}", smt_siblings->first,
+                                             smt_siblings->second)
+                               : std::string("none"))
+              << ", cross-socket: "
+              << (cross_socket ? std::format("cpu {} + {}", cross_socket->first,
+                                             cross_socket->second)
+                               : std::string("none"))
+              << "\n";
+    std::cout << "| Implementation | 1 thread ns/op | cycles/op | SMT siblings ns/op | cycles/op | "
+                 "Cross-socket ns/op | cycles/op |\n"
+              << "|----------------|----------------|-----------|--------------------|-----------|"
+                 "--------------------|-----------|\n";
+
+    caseUncontendedLine(
+        "Simple CAS", []() { return [](size_t) { return getAndIncrementCas(); }; }, smt_siblings,
+        cross_socket);
+    caseUncontendedLine(
+        "Lock", []() { return [](size_t) { return getAndIncrementLock(); }; }, smt_siblings,
+        cross_socket);
+    caseUncontendedLine(
+        "Combiner",
+        []() {
+            return [combiner = std::make_shared<Combiner<NUM_THREADS_PER_COMBINER>>()](
+                       size_t my_id) { return combiner->getAndIncrement(my_id); };
+        },
+        smt_siblings, cross_socket);
+    caseUncontendedLine(
+        "Multi-Round Combiner",
+        []() {
+            return [combiner = std::make_shared<MultiRoundCombiner<
+                        NUM_THREADS_PER_COMBINER, counter_combiner_multi_round>>()](size_t my_id) {
+                return combiner->getAndIncrement(my_id);
+            };
+        },
+        smt_siblings, cross_socket);
+    caseUncontendedLine(
+        "Fair Combiner",
+        []() {
+            return [combiner = std::make_shared<FairCombiner<NUM_THREADS_PER_COMBINER>>(
+                        FAIR_MAX_CONSECUTIVE_ROUNDS)](size_t my_id) {
+                return combiner->getAndIncrement(my_id);
+            };
+        },
+        smt_siblings, cross_socket);
+    caseUncontendedLine(
+        "SNZI Combiner",
+        []() {
+            return [combiner = std::make_shared<SnziCombiner<NUM_THREADS_PER_COMBINER>>()](
+                       size_t my_id) { return combiner->getAndIncrement(my_id); };
+        },
+        smt_siblings, cross_socket);
+    caseUncontendedLine(
+        "Stack Combiner",
+        []() {
+            return [combiner = std::make_shared<StackCombiner>()](size_t) {
+                return combiner->getAndIncrement();
+            };
+        },
+        smt_siblings, cross_socket);
+    // A single server, on the last cpu of the last LLC domain to keep it off the measured cpus
+    // where there are enough; every operation is a round trip to it.
+    caseUncontendedLine(
+        "Delegation",
+        []() {
+            std::vector<std::vector<int>> server_domain = {{detectLlcDomains().back().back()}};
+            return [sequencer = std::make_shared<DelegationSequencer>(server_domain, 2)](
+                       size_t my_id) { return sequencer->getAndIncrement(0, my_id); };
+        },
+        smt_siblings, cross_socket);
+    // Both slots get their numbers for the whole measurement in one phase up front, so this is
+    // the in-phase fast path; the phase barrier is not part of an operation.
+    caseUncontendedLine(
+        "Bulk Synchronous",
+        []() {
+            auto sequencer = std::make_shared<BulkSynchronousSequencer<2>>();
+            for (size_t my_id = 0; my_id < 2; my_id++) {
+                sequencer->request(my_id, UNCONTENDED_WARMUP_OPS + UNCONTENDED_OPS);
+            }
+            std::thread other([&sequencer]() { sequencer->arriveAndWait(); });
+            sequencer->arriveAndWait();
+            other.join();
+            return [sequencer](size_t my_id) { return sequencer->getAndIncrement(my_id); };
+        },
+        smt_siblings, cross_socket);
+    caseUncontendedLine(
+        "k-Relaxed (k=256)",
+        []() {
+            return [sequencer = std::make_shared<RelaxedSequencer<NUM_THREADS>>(256)](
+                       size_t my_id) { return sequencer->getAndIncrement(my_id); };
+        },
+        smt_siblings, cross_socket);
+    caseUncontendedLine(
+        "Epoch, 32-bit sequence",
+        []() {
+            return [sequencer = std::make_shared<EpochSequencer<32>>()](size_t) {
+                return sequencer->getAndIncrement().sequence;
+            };
+        },
+        smt_siblings, cross_socket);
+}
+
+// Busy-waits for the given time, standing in for work between two requests.
+void think(std::chrono::nanoseconds duration) {
+    if (duration.count() == 0) {
+        return;
+    }
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+        cpuRelax();
+    }
+}
+
+template <typename CombinerType, typename... Args>
+std::vector<std::unique_ptr<CombinerType>> makeCombinerGroups(const Args&... args) {
+    std::vector<std::unique_ptr<CombinerType>> combiners;
+    combiners.reserve(NUM_COMBINERS);
+    for (size_t combiner_i = 0; combiner_i < NUM_COMBINERS; combiner_i++) {
+        combiners.emplace_back(std::make_unique<CombinerType>(args...));
+    }
+    return combiners;
+}
+
+// Think time between requests and a class name for every thread. A paced profile's think times
+// are request periods instead: the thread issues requests open-loop at start + k * period, so its
+// rate does not depend on how long the sequencer takes (until it cannot keep up).
+struct RateProfile {
+    std::string name;
+    std::vector<std::chrono::nanoseconds> think_times;
+    std::vector<std::string> classes;
+    bool paced = false;
+};
+
+const std::chrono::nanoseconds SKEW_COLD_THINK_TIME{2000};
+const std::chrono::nanoseconds SKEW_LONG_THINK_TIME{50000};
+const std::chrono::nanoseconds SKEW_ZIPF_BASE_PERIOD{1000};
+const double SKEW_ZIPF_EXPONENT = 1.0;
+const std::chrono::milliseconds SKEW_RUN_DURATION{500};
+
+std::vector<RateProfile> makeRateProfiles() {
+    std::vector<RateProfile> profiles;
+
+    RateProfile uniform{"Uniform", {}, {}};
+    // one hot thread per combiner group, all others cold
+    RateProfile hot_cold{"Hot/cold", {}, {}};
+    // thread i requests every SKEW_ZIPF_BASE_PERIOD * (i + 1)^s, at a rate proportional to
+    // 1 / (i + 1)^s; classes are rank quartiles
+    RateProfile zipf{"Zipf", {}, {}, true};
+    RateProfile long_think{"Long think", {}, {}};
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        uniform.think_times.emplace_back(0);
+        uniform.classes.emplace_back("all");
+
+        bool hot = thread % NUM_THREADS_PER_COMBINER == 0;
+        hot_cold.think_times.push_back(hot ? std::chrono::nanoseconds(0) : SKEW_COLD_THINK_TIME);
+        hot_cold.classes.emplace_back(hot ? "hot" : "cold");
+
+        double period_factor = std::pow(static_cast<double>(thread + 1), SKEW_ZIPF_EXPONENT);
+        zipf.think_times.emplace_back(static_cast<int64_t>(
+            static_cast<double>(SKEW_ZIPF_BASE_PERIOD.count()) * period_factor));
+        zipf.classes.push_back(std::format("rank {}-{}", thread / 4 * 4 + 1, thread / 4 * 4 + 4));
+
+        bool thinking = thread % 2 == 1;
+        long_think.think_times.push_back(thinking ? SKEW_LONG_THINK_TIME
+                                                  : std::chrono::nanoseconds(0));
+        long_think.classes.emplace_back(thinking ? "long think" : "no think");
+    }
+    profiles.push_back(uniform);
+    profiles.push_back(hot_cold);
+    profiles.push_back(zipf);
+    profiles.push_back(long_think);
+    return profiles;
+}
+
+// Runs all threads with their profile's think time or pacing for SKEW_RUN_DURATION and reports
+// throughput and sampled latency per thread class.
+template <typename GetAndIncrement>
+void caseSkewLine(const RateProfile& profile,
+                  const std::string& name,
+                  GetAndIncrement get_and_increment) {
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::vector<std::vector<uint64_t>> latencies(NUM_THREADS);
+    std::vector<uint64_t> operations(NUM_THREADS);
+    std::atomic<bool> stop{false};
+
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        threads.emplace_back([&, thread]() {
+            auto think_time = profile.think_times[thread];
+            auto& my_latencies = latencies[thread];
+            auto next_start = std::chrono::steady_clock::now();
+            uint64_t i = 0;
+            for (; !stop.load(std::memory_order_relaxed); ++i) {
+                if (profile.paced) {
+                    next_start += think_time;
+                    while (std::chrono::steady_clock::now() < next_start) {
+                        cpuRelax();
+                    }
+                } else {
+                    think(think_time);
+                }
+                if (i % LATENCY_SAMPLE_INTERVAL != 0) {
+                    get_and_increment(thread / NUM_THREADS_PER_COMBINER,
+                                      thread % NUM_THREADS_PER_COMBINER);
+                    continue;
+                }
+                auto start = std::chrono::steady_clock::now();
+                get_and_increment(thread / NUM_THREADS_PER_COMBINER,
+                                  thread % NUM_THREADS_PER_COMBINER);
+                auto end = std::chrono::steady_clock::now();
+                my_latencies.push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+            operations[thread] = i;
+        });
+    }
+    std::this_thread::sleep_for(SKEW_RUN_DURATION);
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::map<std::string, std::pair<size_t, uint64_t>> threads_and_operations;
+    std::map<std::string, std::vector<uint64_t>> class_latencies;
+    std::vector<std::string> class_order;
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        const std::string& thread_class = profile.classes[thread];
+        if (!threads_and_operations.contains(thread_class)) {
+            class_order.push_back(thread_class);
+        }
+        threads_and_operations[thread_class].first++;
+        threads_and_operations[thread_class].second += operations[thread];
+        auto& samples = class_latencies[thread_class];
+        samples.insert(samples.end(), latencies[thread].begin(), latencies[thread].end());
+    }
+    double seconds = std::chrono::duration<double>(SKEW_RUN_DURATION).count();
+    for (const auto& thread_class : class_order) {
+        auto [num_threads, class_operations] = threads_and_operations[thread_class];
+        auto& samples = class_latencies[thread_class];
+        uint64_t p50 = percentile(samples, 0.5);
+        uint64_t p99 = percentile(samples, 0.99);
+        std::cout << std::format("| {} | {} | {} | {} | {:.2f} | {} | {} |\n", profile.name, name,
+                                 thread_class, num_threads,
+                                 static_cast<double>(class_operations) / seconds / 1000000, p50,
+                                 p99);
+    }
+}
+
+// Calls run(name, get_and_increment) with a fresh instance of every sequencer the workload modes
+// compare. get_and_increment takes the combiner group and the id within the group.
+template <typename Run>
+void forEachWorkloadSequencer(Run run) {
+    run("Simple CAS", [](size_t, size_t) { return getAndIncrementCas(); });
+    run("Lock", [](size_t, size_t) { return getAndIncrementLock(); });
+
+    auto combiners = makeCombinerGroups<Combiner<NUM_THREADS_PER_COMBINER>>();
+    run("Combiner", [&combiners](size_t group, size_t my_id) {
+        return combiners[group]->getAndIncrement(my_id);
+    });
+
+    auto multi_round_combiners = makeCombinerGroups<
+        MultiRoundCombiner<NUM_THREADS_PER_COMBINER, counter_combiner_multi_round>>();
+    run("Multi-Round Combiner", [&multi_round_combiners](size_t group, size_t my_id) {
+        return multi_round_combiners[group]->getAndIncrement(my_id);
+    });
+
+    auto snzi_combiners = makeCombinerGroups<SnziCombiner<NUM_THREADS_PER_COMBINER>>();
+    run("SNZI Combiner", [&snzi_combiners](size_t group, size_t my_id) {
+        return snzi_combiners[group]->getAndIncrement(my_id);
+    });
+
+    StackCombiner stack_combiner;
+    run("Stack Combiner",
+        [&stack_combiner](size_t, size_t) { return stack_combiner.getAndIncrement(); });
+}
+
+void caseSkew() {
+    std::cout << "\n=== Skewed Request Rates ===\n";
+    std::cout << "| Profile | Implementation | Class | Threads | Throughput (M ops/sec) | "
+                 "p50 (ns) | p99 (ns) |\n"
+              << "|---------|----------------|-------|---------|------------------------|"
+                 "----------|----------|\n";
+
+    for (const auto& profile : makeRateProfiles()) {
+        forEachWorkloadSequencer([&profile](const std::string& name, auto get_and_increment) {
+            caseSkewLine(profile, name, get_and_increment);
+        });
+    }
+}
+
+// Durations of the alternating phases of './main burst [quiet ms] [burst ms]'. The quiet phase
+// between two synchronised bursts is config.quiet_duration as well.
+struct BurstConfig {
+    std::chrono::milliseconds quiet_duration{20};
+    std::chrono::milliseconds burst_duration{20};
+};
+
+const std::chrono::nanoseconds BURST_QUIET_THINK_TIME{20000};
+const size_t BURST_CYCLES = 10;
+const std::chrono::microseconds BURST_SAMPLE_INTERVAL{100};
+// a burst has ramped up once one sample interval reaches this fraction of its second-half rate
+const double BURST_SETTLED_FRACTION = 0.9;
+const size_t BURST_BATCHES = 20;
+const uint64_t BURST_BATCH_SIZE = 1000;
+
+struct BurstSample {
+    std::chrono::steady_clock::time_point time;
+    uint64_t operations;
+};
+
+// Time from the start of a burst phase until the first sample interval that reaches
+// BURST_SETTLED_FRACTION of the rate over the second half of the phase.
+std::chrono::microseconds rampUpTime(const std::vector<BurstSample>& samples) {
+    if (samples.size() < 3) {
+        return std::chrono::microseconds(0);
+    }
+    auto rate = [](const BurstSample& from, const BurstSample& to) {
+        double seconds = std::chrono::duration<double>(to.time - from.time).count();
+        return seconds > 0 ? static_cast<double>(to.operations - from.operations) / seconds : 0;
+    };
+    double settled_rate = rate(samples[samples.size() / 2], samples.back());
+    for (size_t i = 1; i < samples.size(); i++) {
+        if (rate(samples[i - 1], samples[i]) >= BURST_SETTLED_FRACTION * settled_rate) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(samples[i].time -
+                                                                         samples[0].time);
+        }
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(samples.back().time -
+                                                                 samples[0].time);
+}
+
+// Alternates BURST_CYCLES times between a quiet phase, in which every thread thinks
+// BURST_QUIET_THINK_TIME between two requests, and a burst phase without think time. The main
+// thread flips the phase and samples the completed operations every BURST_SAMPLE_INTERVAL.
+template <typename GetAndIncrement>
+void caseBurstPhaseLine(const BurstConfig& config,
+                        const std::string& name,
+                        GetAndIncrement get_and_increment) {
+    struct alignas(CACHE_LINE_SIZE) ThreadState {
+        std::atomic<uint64_t> operations{0};
+        // sampled latencies in the quiet and in the burst phase
+        std::array<std::vector<uint64_t>, 2> latencies;
+    };
+    std::vector<ThreadState> states(NUM_THREADS);
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::atomic<bool> bursting{false};
+    std::atomic<bool> stop{false};
+
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        threads.emplace_back([&, thread]() {
+            auto& state = states[thread];
+            for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+                bool burst = bursting.load(std::memory_order_relaxed);
+                if (!burst) {
+                    think(BURST_QUIET_THINK_TIME);
+                }
+                if (i % LATENCY_SAMPLE_INTERVAL != 0) {
+                    get_and_increment(thread / NUM_THREADS_PER_COMBINER,
+                                      thread % NUM_THREADS_PER_COMBINER);
+                } else {
+                    auto start = std::chrono::steady_clock::now();
+                    get_and_increment(thread / NUM_THREADS_PER_COMBINER,
+                                      thread % NUM_THREADS_PER_COMBINER);
+                    auto end = std::chrono::steady_clock::now();
+                    state.latencies[burst].push_back(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+                }
+                state.operations.store(i + 1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    auto sample = [&states]() {
+        uint64_t operations = 0;
+        for (const auto& state : states) {
+            operations += state.operations.load(std::memory_order_relaxed);
+        }
+        return BurstSample{std::chrono::steady_clock::now(), operations};
+    };
+    // the samples of every phase, starting with one at the phase change
+    std::array<std::vector<std::vector<BurstSample>>, 2> phases;
+    for (size_t cycle = 0; cycle < BURST_CYCLES; cycle++) {
+        for (bool burst : {false, true}) {
+            bursting = burst;
+            auto& samples = phases[burst].emplace_back();
+            samples.push_back(sample());
+            auto phase_end =
+                samples[0].time + (burst ? config.burst_duration : config.quiet_duration);
+            for (auto next = samples[0].time + BURST_SAMPLE_INTERVAL; next < phase_end;
+                 next += BURST_SAMPLE_INTERVAL) {
+                std::this_thread::sleep_until(next);
+                samples.push_back(sample());
+            }
+            std::this_thread::sleep_until(phase_end);
+            samples.push_back(sample());
+        }
+    }
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::string line = "| " + name + " |";
+    for (bool burst : {false, true}) {
+        uint64_t operations = 0;
+        std::chrono::steady_clock::duration duration{0};
+        for (const auto& samples : phases[burst]) {
+            operations += samples.back().operations - samples.front().operations;
+            duration += samples.back().time - samples.front().time;
+        }
+        std::vector<uint64_t> latencies;
+        for (const auto& state : states) {
+            latencies.insert(latencies.end(), state.latencies[burst].begin(),
+                             state.latencies[burst].end());
+        }
+        line += std::format(
+            " {:.2f} | {} | {} |",
+            static_cast<double>(operations) / std::chrono::duration<double>(duration).count() /
+                1000000,
+            percentile(latencies, 0.5), percentile(latencies, 0.99));
+    }
+    std::chrono::microseconds total_ramp_up{0};
+    std::chrono::microseconds max_ramp_up{0};
+    for (const auto& samples : phases[true]) {
+        auto ramp_up = rampUpTime(samples);
+        total_ramp_up += ramp_up;
+        max_ramp_up = std::max(max_ramp_up, ramp_up);
+    }
+    std::cout << line
+              << std::format(" {} | {} |\n", total_ramp_up.count() / BURST_CYCLES,
+                             max_ramp_up.count());
+}
+
+// Synchronised bursts at batch boundaries: every thread sleeps for the quiet duration, all of them
+// are released together by a barrier and take BURST_BATCH_SIZE ids back to back.
+template <typename GetAndIncrement>
+void caseBurstBatchLine(const BurstConfig& config,
+                        const std::string& name,
+                        GetAndIncrement get_and_increment) {
+    using TimePoint = std::chrono::steady_clock::time_point;
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::barrier barrier(NUM_THREADS);
+    std::vector<std::vector<std::pair<TimePoint, TimePoint>>> batch_times(NUM_THREADS);
+    std::vector<std::vector<uint64_t>> first_latencies(NUM_THREADS);
+    std::vector<std::vector<uint64_t>> latencies(NUM_THREADS);
+
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        threads.emplace_back([&, thread]() {
+            for (size_t batch = 0; batch < BURST_BATCHES; batch++) {
+                std::this_thread::sleep_for(config.quiet_duration);
+                barrier.arrive_and_wait();
+                auto batch_start = std::chrono::steady_clock::now();
+                auto start = batch_start;
+                for (uint64_t i = 0; i < BURST_BATCH_SIZE; ++i) {
+                    if (i % LATENCY_SAMPLE_INTERVAL != 0) {
+                        get_and_increment(thread / NUM_THREADS_PER_COMBINER,
+                                          thread % NUM_THREADS_PER_COMBINER);
+                        continue;
+                    }
+                    if (i != 0) {
+                        start = std::chrono::steady_clock::now();
+                    }
+                    get_and_increment(thread / NUM_THREADS_PER_COMBINER,
+                                      thread % NUM_THREADS_PER_COMBINER);
+                    auto end = std::chrono::steady_clock::now();
+                    uint64_t latency =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+                    (i == 0 ? first_latencies : latencies)[thread].push_back(latency);
+                }
+                batch_times[thread].emplace_back(batch_start, std::chrono::steady_clock::now());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // a batch lasts from the first thread leaving the barrier until the last one is done
+    std::vector<uint64_t> makespans;
+    for (size_t batch = 0; batch < BURST_BATCHES; batch++) {
+        TimePoint start = TimePoint::max();
+        TimePoint end = TimePoint::min();
+        for (const auto& times : batch_times) {
+            start = std::min(start, times[batch].first);
+            end = std::max(end, times[batch].second);
+        }
+        makespans.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+    }
+    auto merge = [](const std::vector<std::vector<uint64_t>>& per_thread) {
+        std::vector<uint64_t> merged;
+        for (const auto& samples : per_thread) {
+            merged.insert(merged.end(), samples.begin(), samples.end());
+        }
+        return merged;
+    };
+    auto all_first_latencies = merge(first_latencies);
+    auto all_latencies = merge(latencies);
+    uint64_t total_makespan = 0;
+    for (uint64_t makespan : makespans) {
+        total_makespan += makespan;
+    }
+    double operations = static_cast<double>(NUM_THREADS * BURST_BATCH_SIZE * BURST_BATCHES);
+    std::cout << std::format(
+        "| {} | {:.2f} | {} | {} | {} | {} | {} | {} |\n", name,
+        operations / static_cast<double>(std::max<uint64_t>(total_makespan, 1)),
+        percentile(makespans, 0.5), percentile(makespans, 1.0),
+        percentile(all_first_latencies, 0.5), percentile(all_first_latencies, 0.99),
+        percentile(all_latencies, 0.5), percentile(all_latencies, 0.99));
+}
+
+void caseBurst(const BurstConfig& config) {
+    std::cout << "\n=== Quiet/Burst Phases ===\n";
+    std::cout << std::format("{} cycles of {} ms quiet ({} ns think time) and {} ms burst, "
+                             "sampled every {} us\n",
+                             BURST_CYCLES, config.quiet_duration.count(),
+                             BURST_QUIET_THINK_TIME.count(), config.burst_duration.count(),
+                             BURST_SAMPLE_INTERVAL.count());
+    std::cout << "| Implementation | Quiet (M ops/sec) | Quiet p50 (ns) | Quiet p99 (ns) | "
+                 "Burst (M ops/sec) | Burst p50 (ns) | Burst p99 (ns) | Ramp-up mean (us) | "
+                 "Ramp-up max (us) |\n"
+              << "|----------------|-------------------|----------------|----------------|"
+                 "-------------------|----------------|----------------|-------------------|"
+                 "------------------|\n";
+    forEachWorkloadSequencer([&config](const std::string& name, auto get_and_increment) {
+        caseBurstPhaseLine(config, name, get_and_increment);
+    });
+
+    std::cout << "\n=== Synchronised Bursts ===\n";
+    std::cout << std::format("{} batches of {} ids per thread after a barrier, {} ms apart\n",
+                             BURST_BATCHES, BURST_BATCH_SIZE, config.quiet_duration.count());
+    std::cout << "| Implementation | Burst (M ops/sec) | Batch p50 (us) | Batch max (us) | "
+                 "First request p50 (ns) | First request p99 (ns) | p50 (ns) | p99 (ns) |\n"
+              << "|----------------|-------------------|----------------|----------------|"
+                 "------------------------|------------------------|----------|----------|\n";
+    forEachWorkloadSequencer([&config](const std::string& name, auto get_and_increment) {
+        caseBurstBatchLine(config, name, get_and_increment);
+    });
+}
+
+const size_t CHURN_DEFAULT_MEAN_IDS = 16;
+const size_t CHURN_THREADS_PER_SPAWNER = 1000;
+
+// NUM_THREADS spawners each start CHURN_THREADS_PER_SPAWNER short-lived threads one after the
+// other. Every thread registers, takes 1 + Geometric(1 / mean_ids) ids and deregisters. With
+// uses_slots, registering acquires a slot from a SlotRegistry and deregistering calls retire(slot),
+// which returns the leased numbers the thread leaves behind unissued, and releases the slot. Once
+// all threads are gone, leftover() counts the sequencer's per-slot state they left behind.
+template <typename GetAndIncrement, typename Retire, typename Leftover>
+void caseChurnLine(const std::string& name,
+                   size_t mean_ids,
+                   bool uses_slots,
+                   GetAndIncrement get_and_increment,
+                   Retire retire,
+                   Leftover leftover) {
+    SlotRegistry<NUM_THREADS> registry;
+    std::atomic<uint64_t> operations{0};
+    std::atomic<uint64_t> register_ns{0};
+    std::atomic<uint64_t> deregister_ns{0};
+    std::atomic<uint64_t> unissued{0};
+    std::vector<std::thread> spawners;
+    spawners.reserve(NUM_THREADS);
+
+    auto start_time = std::chrono::steady_clock::now();
+    for (size_t spawner = 0; spawner < NUM_THREADS; spawner++) {
+        spawners.emplace_back([&, spawner]() {
+            std::mt19937_64 random(spawner);
+            std::geometric_distribution<uint64_t> extra_ids(1.0 / static_cast<double>(mean_ids));
+            for (size_t thread_i = 0; thread_i < CHURN_THREADS_PER_SPAWNER; thread_i++) {
+                uint64_t ids = 1 + extra_ids(random);
+                std::thread worker([&, ids, spawner]() {
+                    auto register_start = std::chrono::steady_clock::now();
+                    size_t slot = spawner;
+                    if (uses_slots) {
+                        std::optional<size_t> acquired;
+                        size_t spins = 0;
+                        while (!(acquired = registry.acquire())) {
+                            spinWait(spins);
+                        }
+                        slot = *acquired;
+                    }
+                    auto register_end = std::chrono::steady_clock::now();
+                    for (uint64_t i = 0; i < ids; ++i) {
+                        get_and_increment(slot);
+                    }
+                    auto deregister_start = std::chrono::steady_clock::now();
+                    if (uses_slots) {
+                        unissued += retire(slot);
+                        registry.release(slot);
+                    }
+                    auto deregister_end = std::chrono::steady_clock::now();
+                    operations += ids;
+                    register_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       register_end - register_start)
+                                       .count();
+                    deregister_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         deregister_end - deregister_start)
+                                         .count();
+                });
+                worker.join();
+            }
+        });
+    }
+    for (auto& spawner : spawners) {
+        spawner.join();
+    }
+    double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    double threads = static_cast<double>(NUM_THREADS * CHURN_THREADS_PER_SPAWNER);
+    std::cout << std::format("| {} | {:.2f} | {:.0f} | {:.1f} | {:.1f} | {} | {:.2f} |\n", name,
+                             static_cast<double>(operations.load()) / seconds / 1000000,
+                             threads / seconds,
+                             static_cast<double>(register_ns.load()) / threads,
+                             static_cast<double>(deregister_ns.load()) / threads,
+                             uses_slots ? std::to_string(leftover()) : std::string("n/a"),
+                             static_cast<double>(unissued.load()) / threads);
+}
+
+// Short-lived threads with a mean of mean_ids >= 1 ids each, as in a thread-per-request service.
+// Sequencers without per-thread state skip registration and show its bare timing overhead.
+void caseChurn(size_t mean_ids) {
+    std::cout << "\n=== Thread Churn ===\n";
+    std::cout << std::format("{} threads, {} at a time, 1 + Geometric ids per thread with mean "
+                             "{}\n",
+                             NUM_THREADS * CHURN_THREADS_PER_SPAWNER, NUM_THREADS, mean_ids);
+    std::cout << "| Implementation | Throughput (M ops/sec) | Threads/sec | Register (ns) | "
+                 "Deregister (ns) | Leftover slot state | Unissued numbers/thread |\n"
+              << "|----------------|------------------------|-------------|---------------|"
+                 "-----------------|---------------------|-------------------------|\n";
+
+    auto no_retire = [](size_t) { return uint64_t{0}; };
+    auto no_state = []() { return size_t{0}; };
+    // interested flags still raised in any of the groups
+    auto interested_slots = [](const auto& groups) {
+        return [&groups]() {
+            size_t slots = 0;
+            for (const auto& group : groups) {
+                slots += group->interestedSlots();
+            }
+            return slots;
+        };
+    };
+    caseChurnLine(
+        "Simple CAS", mean_ids, false, [](size_t) { return getAndIncrementCas(); }, no_retire,
+        no_state);
+    caseChurnLine(
+        "Lock", mean_ids, false, [](size_t) { return getAndIncrementLock(); }, no_retire,
+        no_state);
+
+    auto combiners = makeCombinerGroups<Combiner<NUM_THREADS_PER_COMBINER>>();
+    caseChurnLine(
+        "Combiner", mean_ids, true,
+        [&combiners](size_t slot) {
+            return combiners[slot / NUM_THREADS_PER_COMBINER]->getAndIncrement(
+                slot % NUM_THREADS_PER_COMBINER);
+        },
+        no_retire, interested_slots(combiners));
+
+    auto multi_round_combiners = makeCombinerGroups<
+        MultiRoundCombiner<NUM_THREADS_PER_COMBINER, counter_combiner_multi_round>>();
+    caseChurnLine(
+        "Multi-Round Combiner", mean_ids, true,
+        [&multi_round_combiners](size_t slot) {
+            return multi_round_combiners[slot / NUM_THREADS_PER_COMBINER]->getAndIncrement(
+                slot % NUM_THREADS_PER_COMBINER);
+        },
+        no_retire, interested_slots(multi_round_combiners));
+
+    auto snzi_combiners = makeCombinerGroups<SnziCombiner<NUM_THREADS_PER_COMBINER>>();
+    caseChurnLine(
+        "SNZI Combiner", mean_ids, true,
+        [&snzi_combiners](size_t slot) {
+            return snzi_combiners[slot / NUM_THREADS_PER_COMBINER]->getAndIncrement(
+                slot % NUM_THREADS_PER_COMBINER);
+        },
+        no_retire, [&snzi_combiners, interested = interested_slots(snzi_combiners)]() {
+            // leaves with a surplus as well
+            size_t leftover = interested();
+            for (const auto& combiner : snzi_combiners) {
+                leftover += combiner->pendingLeaves();
+            }
+            return leftover;
+        });
+
+    StackCombiner stack_combiner;
+    caseChurnLine(
+        "Stack Combiner", mean_ids, false,
+        [&stack_combiner](size_t) { return stack_combiner.getAndIncrement(); }, no_retire,
+        no_state);
+
+    for (uint64_t k : {16, 256}) {
+        auto relaxed = std::make_unique<RelaxedSequencer<NUM_THREADS>>(k);
+        caseChurnLine(
+            std::format("k-Relaxed (k={})", k), mean_ids, true,
+            [&relaxed](size_t slot) { return relaxed->getAndIncrement(slot); },
+            [&relaxed](size_t slot) { return relaxed->retire(slot); },
+            [&relaxed]() { return relaxed->unretiredLeases(); });
+    }
+}
+
+const std::array<size_t, 5> HEATMAP_THREAD_COUNTS = {1, 2, 4, 8, 16};
+const std::array<std::chrono::nanoseconds, 5> HEATMAP_THINK_TIMES = {
+    std::chrono::nanoseconds(0), std::chrono::nanoseconds(100), std::chrono::nanoseconds(500),
+    std::chrono::nanoseconds(2000), std::chrono::nanoseconds(10000)};
+const std::chrono::milliseconds HEATMAP_RUN_DURATION{100};
+const std::string HEATMAP_OUTPUT_PREFIX = "heatmap";
+// fill colours of the strategies, in the order of forEachHeatmapSequencer
+const std::array<const char*, 8> HEATMAP_COLORS = {"#4e79a7", "#f28e2b", "#59a14f", "#e15759",
+                                                   "#b07aa1", "#edc948", "#76b7b2", "#9c755f"};
+
+// forEachWorkloadSequencer plus the Fair Combiner and Delegation, so the heatmap covers every
+// sequencer that hands out plain increments. Delegation's servers, one per LLC domain, run on top
+// of the counted threads.
+template <typename Run>
+void forEachHeatmapSequencer(Run run) {
+    forEachWorkloadSequencer(run);
+
+    auto fair_combiners =
+        makeCombinerGroups<FairCombiner<NUM_THREADS_PER_COMBINER>>(FAIR_MAX_CONSECUTIVE_ROUNDS);
+    run("Fair Combiner", [&fair_combiners](size_t group, size_t my_id) {
+        return fair_combiners[group]->getAndIncrement(my_id);
+    });
+
+    auto llc_domains = detectLlcDomains();
+    DelegationSequencer delegation(llc_domains,
+                                   (NUM_THREADS + llc_domains.size() - 1) / llc_domains.size());
+    run("Delegation", [&delegation, domains = llc_domains.size()](size_t group, size_t my_id) {
+        // spread round-robin over the domains as in caseDelegation
+        size_t thread = group * NUM_THREADS_PER_COMBINER + my_id;
+        return delegation.getAndIncrement(thread % domains, thread / domains);
+    });
+}
+
+// Throughput in M ops/sec of num_threads threads that think for think_time before every request,
+// over the given duration.
+template <typename GetAndIncrement>
+double measureThroughput(size_t num_threads,
+                         std::chrono::nanoseconds think_time,
+                         std::chrono::milliseconds duration,
+                         GetAndIncrement get_and_increment) {
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    std::vector<uint64_t> operations(num_threads);
+    std::atomic<bool> stop{false};
+
+    auto start_time = std::chrono::steady_clock::now();
+    for (size_t thread = 0; thread < num_threads; thread++) {
+        threads.emplace_back([&, thread]() {
+            uint64_t i = 0;
+            for (; !stop.load(std::memory_order_relaxed); ++i) {
+                think(think_time);
+                get_and_increment(thread / NUM_THREADS_PER_COMBINER,
+                                  thread % NUM_THREADS_PER_COMBINER);
+            }
+            operations[thread] = i;
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    uint64_t total = 0;
+    for (uint64_t thread_operations : operations) {
+        total += thread_operations;
+    }
+    return static_cast<double>(total) / seconds.count() / 1000000;
+}
+
+struct HeatmapCell {
+    size_t num_threads;
+    std::chrono::nanoseconds think_time;
+    // M ops/sec per strategy, in the order of forEachHeatmapSequencer
+    std::vector<double> throughputs;
+    size_t best;
+    // how much faster the best strategy is than the runner-up, in percent
+    double margin;
+};
+
+void writeHeatmapCsv(const std::vector<std::string>& strategies,
+                     const std::vector<HeatmapCell>& cells,
+                     const std::string& path) {
+    std::ofstream stream(path);
+    stream << "threads,think_ns";
+    for (const auto& strategy : strategies) {
+        stream << "," << strategy;
+    }
+    stream << ",best,margin_percent\n";
+    for (const auto& cell : cells) {
+        stream << cell.num_threads << "," << cell.think_time.count();
+        for (double throughput : cell.throughputs) {
+            stream << std::format(",{:.3f}", throughput);
+        }
+        stream << "," << strategies[cell.best] << std::format(",{:.1f}\n", cell.margin);
+    }
+}
+
+// One row per thread count and one column per think time; every cell is filled with the colour of
+// its best strategy and labelled with it and its margin.
+void writeHeatmapSvg(const std::vector<std::string>& strategies,
+                     const std::vector<HeatmapCell>& cells,
+                     const std::string& path) {
+    const size_t cell_width = 160;
+    const size_t cell_height = 50;
+    const size_t left = 90;
+    const size_t top = 50;
+    size_t width = left + HEATMAP_THINK_TIMES.size() * cell_width + 20;
+    size_t grid_bottom = top + HEATMAP_THREAD_COUNTS.size() * cell_height;
+    size_t height = grid_bottom + 30 + strategies.size() * 20;
+
+    std::ofstream stream(path);
+    stream << std::format("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"{}\" height=\"{}\" "
+                          "font-family=\"sans-serif\" font-size=\"12\">\n",
+                          width, height)
+           << std::format("<text x=\"{}\" y=\"20\" text-anchor=\"middle\">think time per request "
+                          "(ns)</text>\n",
+                          left + HEATMAP_THINK_TIMES.size() * cell_width / 2)
+           << std::format("<text x=\"15\" y=\"{}\" transform=\"rotate(-90 15 {})\" "
+                          "text-anchor=\"middle\">threads</text>\n",
+                          (top + grid_bottom) / 2, (top + grid_bottom) / 2);
+    for (size_t column = 0; column < HEATMAP_THINK_TIMES.size(); column++) {
+        stream << std::format("<text x=\"{}\" y=\"{}\" text-anchor=\"middle\">{}</text>\n",
+                              left + column * cell_width + cell_width / 2, top - 8,
+                              HEATMAP_THINK_TIMES[column].count());
+    }
+    for (size_t row = 0; row < HEATMAP_THREAD_COUNTS.size(); row++) {
+        stream << std::format("<text x=\"{}\" y=\"{}\" text-anchor=\"end\">{}</text>\n", left - 8,
+                              top + row * cell_height + cell_height / 2 + 4,
+                              HEATMAP_THREAD_COUNTS[row]);
+    }
+    for (size_t cell_i = 0; cell_i < cells.size(); cell_i++) {
+        const auto& cell = cells[cell_i];
+        size_t x = left + (cell_i % HEATMAP_THINK_TIMES.size()) * cell_width;
+        size_t y = top + (cell_i / HEATMAP_THINK_TIMES.size()) * cell_height;
+        stream << std::format("<rect x=\"{}\" y=\"{}\" width=\"{}\" height=\"{}\" fill=\"{}\" "
+                              "stroke=\"white\"/>\n",
+                              x, y, cell_width, cell_height,
+                              HEATMAP_COLORS[cell.best % HEATMAP_COLORS.size()])
+               << std::format("<text x=\"{}\" y=\"{}\" text-anchor=\"middle\">{}</text>\n",
+                              x + cell_width / 2, y + 20, strategies[cell.best])
+               << std::format("<text x=\"{}\" y=\"{}\" text-anchor=\"middle\">{:.2f} M/s, "
+                              "+{:.0f}%</text>\n",
+                              x + cell_width / 2, y + 38, cell.throughputs[cell.best],
+                              cell.margin);
+    }
+    for (size_t strategy = 0; strategy < strategies.size(); strategy++) {
+        size_t y = grid_bottom + 20 + strategy * 20;
+        stream << std::format("<rect x=\"{}\" y=\"{}\" width=\"14\" height=\"14\" fill=\"{}\"/>\n",
+                              left, y, HEATMAP_COLORS[strategy % HEATMAP_COLORS.size()])
+               << std::format("<text x=\"{}\" y=\"{}\">{}</text>\n", left + 20, y + 12,
+                              strategies[strategy]);
+    }
+    stream << "</svg>\n";
+}
+
+// Runs every workload sequencer on a grid of thread counts and think times, prints the best
+// strategy per cell and writes all throughputs to <prefix>.csv and the map to <prefix>.svg.
+void caseHeatmap(const std::string& output_prefix) {
+    std::cout << "\n=== Contention Heatmap ===\n";
+    std::cout << "Best strategy (M ops/sec, margin over the runner-up) per thread count and think "
+                 "time\n"
+              << "Delegation runs one server thread per LLC domain on top of the counted threads\n";
+    std::cout << "| Threads |";
+    for (auto think_time : HEATMAP_THINK_TIMES) {
+        std::cout << " " << think_time.count() << " ns |";
+    }
+    std::cout << "\n|---------|";
+    for (size_t column = 0; column < HEATMAP_THINK_TIMES.size(); column++) {
+        std::cout << "------|";
+    }
+    std::cout << "\n";
+
+    std::vector<std::string> strategies;
+    std::vector<HeatmapCell> cells;
+    for (size_t num_threads : HEATMAP_THREAD_COUNTS) {
+        std::cout << "| " << num_threads << " |";
+        for (auto think_time : HEATMAP_THINK_TIMES) {
+            HeatmapCell cell{num_threads, think_time, {}, 0, 0};
+            strategies.clear();
+            forEachHeatmapSequencer([&](const std::string& name, auto get_and_increment) {
+                strategies.push_back(name);
+                cell.throughputs.push_back(
+                    measureThroughput(num_threads, think_time, HEATMAP_RUN_DURATION,
+                                      get_and_increment));
+            });
+            std::vector<double> sorted = cell.throughputs;
+            std::sort(sorted.begin(), sorted.end(), std::greater<>());
+            cell.best = std::max_element(cell.throughputs.begin(), cell.throughputs.end()) -
+                        cell.throughputs.begin();
+            cell.margin = sorted.size() > 1 && sorted[1] > 0 ? (sorted[0] / sorted[1] - 1) * 100
+                                                             : 0;
+            std::cout << std::format(" {} ({:.2f}, +{:.0f}%) |", strategies[cell.best],
+                                     cell.throughputs[cell.best], cell.margin)
+                      << std::flush;
+            cells.push_back(cell);
+        }
+        std::cout << "\n";
+    }
+
+    writeHeatmapCsv(strategies, cells, output_prefix + ".csv");
+    writeHeatmapSvg(strategies, cells, output_prefix + ".svg");
+    std::cout << "Written to " << output_prefix << ".csv and " << output_prefix << ".svg\n";
+}
+
+struct PrometheusMetric {
+    const char* name;
+    const char* type;
+    const char* help;
+    double (*value)(const SequencerStats&);
+};
+
+const std::array<PrometheusMetric, 7> PROMETHEUS_METRICS = {{
+    {"sequencer_operations_total", "counter", "Sequence number requests.",
+     [](const SequencerStats& stats) { return static_cast<double>(stats.operations); }},
+    {"sequencer_shared_rmws_total", "counter",
+     "Read-modify-writes on cache lines shared between threads.",
+     [](const SequencerStats& stats) { return static_cast<double>(stats.shared_rmws); }},
+    {"sequencer_combining_rounds_total", "counter", "Batches served by a combiner or server.",
+     [](const SequencerStats& stats) { return static_cast<double>(stats.combining_rounds); }},
+    {"sequencer_mean_batch_size", "gauge", "Mean numbers per combining round since start.",
+     [](const SequencerStats& stats) { return stats.meanBatchSize(); }},
+    {"sequencer_spins_total", "counter", "Iterations of wait loops.",
+     [](const SequencerStats& stats) { return static_cast<double>(stats.spins); }},
+    {"sequencer_lease_refills_total", "counter", "Leases taken from the shared counter.",
+     [](const SequencerStats& stats) { return static_cast<double>(stats.lease_refills); }},
+    {"sequencer_fallbacks_total", "counter",
+     "Requests that left the fast path (lost races, expired deadlines, dropped leases).",
+     [](const SequencerStats& stats) { return static_cast<double>(stats.fallbacks); }},
+}};
+
+// Writes the stats in the Prometheus text exposition format, one series per sequencer labelled
+// with its name.
+void writePrometheus(std::ostream& stream,
+                     const std::vector<std::pair<std::string, SequencerStats>>& sequencers) {
+    for (const auto& metric : PROMETHEUS_METRICS) {
+        stream << "# HELP " << metric.name << " " << metric.help << "\n"
+               << "# TYPE " << metric.name << " " << metric.type << "\n";
+        for (const auto& [name, stats] : sequencers) {
+            std::string label;
+            for (char c : name) {
+                if (c == '\\' || c == '"') {
+                    label += '\\';
+                }
+                label += c;
+            }
+            stream << std::format("{}{{sequencer=\"{}\"}} {}\n", metric.name, label,
+                                  metric.value(stats));
+        }
+    }
+}
+
+const std::string STATS_DEFAULT_TARGET = "sequencer_stats.prom";
+const std::chrono::milliseconds STATS_EXPORT_INTERVAL{1000};
+const std::chrono::milliseconds STATS_RUN_DURATION{1000};
+
+// Publishes the stats of the given sequencers in a background thread. A target of the form
+// ":<port>" serves them over HTTP on 127.0.0.1:<port> (Linux only), any other target is a file
+// that is rewritten every STATS_EXPORT_INTERVAL and when the exporter stops.
+class StatsExporter {
+    using Sources = std::vector<std::pair<std::string, std::function<SequencerStats()>>>;
+
+    Sources sources;
+    std::string target;
+    std::atomic<bool> stop{false};
+    std::thread thread;
+
+    std::string render() const {
+        std::vector<std::pair<std::string, SequencerStats>> sequencers;
+        for (const auto& [name, stats] : sources) {
+            sequencers.emplace_back(name, stats());
+        }
+        std::ostringstream stream;
+        writePrometheus(stream, sequencers);
+        return stream.str();
+    }
+
+    // Writes a temporary file and renames it, so a scraper never reads a partial file.
+    void writeFile() const {
+        std::string temporary = target + ".tmp";
+        {
+            std::ofstream stream(temporary);
+            stream << render();
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, target, error);
+    }
+
+    void exportToFile() {
+        while (!stop) {
+            writeFile();
+            auto next = std::chrono::steady_clock::now() + STATS_EXPORT_INTERVAL;
+            while (!stop && std::chrono::steady_clock::now() < next) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        writeFile();
+    }
+
+    // Answers every request on the port with the current stats, whatever its path.
+    void serveHttp(uint16_t port) {
+#ifdef __linux__
+        int server = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (server < 0 ||
+            bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(server, 4) != 0) {
+            std::cerr << "Cannot serve stats on 127.0.0.1:" << port << "\n";
+            if (server >= 0) {
+                close(server);
+            }
+            return;
+        }
+        std::cout << "Serving stats on http://127.0.0.1:" << port << "/metrics\n";
+        while (!stop) {
+            pollfd poll_server{server, POLLIN, 0};
+            if (poll(&poll_server, 1, 100) <= 0) {
+                continue;
+            }
+            int client = accept(server, nullptr, nullptr);
+            if (client < 0) {
+                continue;
+            }
+            std::array<char, 1024> request;
+            [[maybe_unused]] ssize_t ignored = recv(client, request.data(), request.size(), 0);
+            std::string body = render();
+            std::string response = std::format("HTTP/1.0 200 OK\r\n"
+                                               "Content-Type: text/plain; version=0.0.4\r\n"
+                                               "Content-Length: {}\r\n\r\n{}",
+                                               body.size(), body);
+            for (size_t sent = 0; sent < response.size();) {
+                ssize_t written = send(client, response.data() + sent, response.size() - sent, 0);
+                if (written <= 0) {
+                    break;
+                }
+                sent += written;
+            }
+            close(client);
+        }
+        close(server);
+#else
+        std::cerr << "Serving stats over HTTP is only supported on Linux, port " << port
+                  << " ignored\n";
+#endif
+    }
+
+   public:
+    StatsExporter(Sources sources, const std::string& target)
+        : sources(std::move(sources)),
+          target(target) {
+        if (!target.empty() && target.front() == ':') {
+            thread = std::thread([this, port = parseUint64(target.substr(1)).value_or(0)]() {
+                serveHttp(static_cast<uint16_t>(port));
+            });
+        } else {
+            thread = std::thread([this]() { exportToFile(); });
+        }
+    }
+
+    ~StatsExporter() {
+        stop = true;
+        thread.join();
+    }
+};
+
+// Runs the sequencers one after the other with NUM_THREADS threads for STATS_RUN_DURATION each
+// while the exporter publishes their stats, then prints the final snapshot.
+void caseStats(const std::string& target) {
+    auto combiners = makeCombinerGroups<Combiner<NUM_THREADS_PER_COMBINER>>();
+    auto multi_round_combiners = makeCombinerGroups<
+        MultiRoundCombiner<NUM_THREADS_PER_COMBINER, counter_combiner_multi_round>>();
+    auto snzi_combiners = makeCombinerGroups<SnziCombiner<NUM_THREADS_PER_COMBINER>>();
+    StackCombiner stack_combiner;
+    auto llc_domains = detectLlcDomains();
+    DelegationSequencer delegation(llc_domains,
+                                   (NUM_THREADS + llc_domains.size() - 1) / llc_domains.size());
+    auto relaxed = std::make_unique<RelaxedSequencer<NUM_THREADS>>(256);
+
+    auto sum = [](const auto& groups) {
+        return [&groups]() {
+            SequencerStats total;
+            for (const auto& group : groups) {
+                total += group->stats();
+            }
+            return total;
+        };
+    };
+    std::vector<std::pair<std::string, std::function<SequencerStats()>>> sources = {
+        {"Simple CAS", statsCas},
+        {"Lock", statsLock},
+        {"Combiner", sum(combiners)},
+        {"Multi-Round Combiner", sum(multi_round_combiners)},
+        {"SNZI Combiner", sum(snzi_combiners)},
+        {"Stack Combiner", [&stack_combiner]() { return stack_combiner.stats(); }},
+        {"Delegation", [&delegation]() { return delegation.stats(); }},
+        {"k-Relaxed (k=256)", [&relaxed]() { return relaxed->stats(); }},
+    };
+
+    {
+        StatsExporter exporter(sources, target);
+        auto run = [](auto get_and_increment) {
+            measureThroughput(NUM_THREADS, std::chrono::nanoseconds(0), STATS_RUN_DURATION,
+                              get_and_increment);
+        };
+        run([](size_t, size_t) { return getAndIncrementCas(); });
+        run([](size_t, size_t) { return getAndIncrementLock(); });
+        run([&combiners](size_t group, size_t my_id) {
+            return combiners[group]->getAndIncrement(my_id);
+        });
+        run([&multi_round_combiners](size_t group, size_t my_id) {
+            return multi_round_combiners[group]->getAndIncrement(my_id);
+        });
+        run([&snzi_combiners](size_t group, size_t my_id) {
+            return snzi_combiners[group]->getAndIncrement(my_id);
+        });
+        run([&stack_combiner](size_t, size_t) { return stack_combiner.getAndIncrement(); });
+        run([&delegation, &llc_domains](size_t group, size_t my_id) {
+            size_t thread = group * NUM_THREADS_PER_COMBINER + my_id;
+            return delegation.getAndIncrement(thread % llc_domains.size(),
+                                              thread / llc_domains.size());
+        });
+        run([&relaxed](size_t group, size_t my_id) {
+            return relaxed->getAndIncrement(group * NUM_THREADS_PER_COMBINER + my_id);
+        });
+    }
+
+    std::cout << "\n=== Sequencer Stats ===\n";
+    std::cout << "| Implementation | Operations | Shared RMWs/op | Rounds | Mean batch | "
+                 "Spins/op | Lease refills | Fallbacks |\n"
+              << "|----------------|------------|----------------|--------|------------|"
+                 "----------|---------------|-----------|\n";
+    for (const auto& [name, read_stats] : sources) {
+        SequencerStats stats = read_stats();
+        double operations = static_cast<double>(std::max<uint64_t>(stats.operations, 1));
+        std::cout << std::format("| {} | {} | {:.2f} | {} | {:.2f} | {:.2f} | {} | {} |\n", name,
+                                 stats.operations,
+                                 static_cast<double>(stats.shared_rmws) / operations,
+                                 stats.combining_rounds, stats.meanBatchSize(),
+                                 static_cast<double>(stats.spins) / operations,
+                                 stats.lease_refills, stats.fallbacks);
+    }
+    if (target.empty() || target.front() != ':') {
+        std::cout << "Written to " << target << "\n";
+    }
+}
+
+const double PREEMPT_DEFAULT_PROBABILITY = 0.001;
+const std::chrono::microseconds PREEMPT_DEFAULT_DURATION{50};
+const std::chrono::milliseconds PREEMPT_RUN_DURATION{500};
+
+struct PreemptMeasurement {
+    double throughput;
+    std::vector<uint64_t> latencies;
+    uint64_t preemptions;
+};
+
+// NUM_THREADS threads without think time for PREEMPT_RUN_DURATION, with sampled latencies.
+template <typename GetAndIncrement>
+PreemptMeasurement measurePreemption(GetAndIncrement get_and_increment) {
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+    std::vector<std::vector<uint64_t>> latencies(NUM_THREADS);
+    std::vector<uint64_t> operations(NUM_THREADS);
+    std::atomic<bool> stop{false};
+    uint64_t preemptions_start = injected_preemptions.load();
+
+    auto start_time = std::chrono::steady_clock::now();
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        threads.emplace_back([&, thread]() {
+            auto& my_latencies = latencies[thread];
+            uint64_t i = 0;
+            for (; !stop.load(std::memory_order_relaxed); ++i) {
+                if (i % LATENCY_SAMPLE_INTERVAL != 0) {
+                    get_and_increment(thread / NUM_THREADS_PER_COMBINER,
+                                      thread % NUM_THREADS_PER_COMBINER);
+                    continue;
+                }
+                auto start = std::chrono::steady_clock::now();
+                get_and_increment(thread / NUM_THREADS_PER_COMBINER,
+                                  thread % NUM_THREADS_PER_COMBINER);
+                auto end = std::chrono::steady_clock::now();
+                my_latencies.push_back(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+            }
+            operations[thread] = i;
+        });
+    }
+    std::this_thread::sleep_for(PREEMPT_RUN_DURATION);
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+
+    PreemptMeasurement measurement{0, {}, injected_preemptions.load() - preemptions_start};
+    uint64_t total = 0;
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        total += operations[thread];
+        measurement.latencies.insert(measurement.latencies.end(), latencies[thread].begin(),
+                                     latencies[thread].end());
+    }
+    measurement.throughput = static_cast<double>(total) / seconds.count() / 1000000;
+    return measurement;
+}
+
+// Runs every workload sequencer once without and once with the given preemption injection and
+// reports the change in throughput and tail latency. Simple CAS has no critical section and serves
+// as the control.
+void casePreempt(const PreemptionInjection& injection) {
+    std::cout << "\n=== Preemption Injection ===\n";
+    std::cout << std::format("p = {} per critical section, {}\n", injection.probability,
+                             injection.yield
+                                 ? std::string("yield")
+                                 : std::format("sleep {} us", injection.duration.count()));
+    std::cout << "| Implementation | Injected | Throughput (M ops/sec) | Change | p50 (ns) | "
+                 "p99 (ns) | p99.9 (ns) | Max (ns) |\n"
+              << "|----------------|----------|------------------------|--------|----------|"
+                 "----------|------------|----------|\n";
+
+    forEachWorkloadSequencer([&injection](const std::string& name, auto get_and_increment) {
+        double baseline_throughput = 0;
+        for (bool injected : {false, true}) {
+            preemption_injection = injected ? injection : PreemptionInjection{};
+            auto measurement = measurePreemption(get_and_increment);
+            preemption_injection = PreemptionInjection{};
+            if (!injected) {
+                baseline_throughput = measurement.throughput;
+            }
+            auto& latencies = measurement.latencies;
+            std::cout << std::format(
+                "| {} | {} | {:.2f} | {} | {} | {} | {} | {} |\n", name,
+                injected ? std::to_string(measurement.preemptions) : std::string("no"),
+                measurement.throughput,
+                injected && baseline_throughput > 0
+                    ? std::format("{:+.1f}%",
+                                  (measurement.throughput / baseline_throughput - 1) * 100)
+                    : std::string("-"),
+                percentile(latencies, 0.5), percentile(latencies, 0.99),
+                percentile(latencies, 0.999), percentile(latencies, 1.0));
+        }
+    });
+}
+
+const size_t TABLE_SHARDS = 64;
+const uint64_t TABLE_ROWS_PER_THREAD = COUNT_PER_THREAD / 100;
+
+// A 64-byte row, tagged with the id from the sequencer under test.
+struct TableRecord {
+    uint64_t id;
+    uint64_t key;
+    std::array<uint64_t, 6> payload;
+};
+
+// Concurrent hash table of independently locked shards, the kind of structure whose inserts take
+// an id from a sequencer in a real service.
+class ShardedTable {
+    struct alignas(CACHE_LINE_SIZE) Shard {
+        std::mutex lock;
+        std::unordered_map<uint64_t, TableRecord> rows;
+    };
+
+    std::array<Shard, TABLE_SHARDS> shards;
+
+   public:
+    explicit ShardedTable(size_t expected_rows) {
+        for (auto& shard : shards) {
+            shard.rows.reserve(expected_rows / TABLE_SHARDS);
+        }
+    }
+
+    void insert(const TableRecord& record) {
+        auto& shard = shards[(record.key >> 32) % TABLE_SHARDS];
+        std::lock_guard guard(shard.lock);
+        shard.rows.emplace(record.key, record);
+    }
+
+    size_t size() {
+        size_t rows = 0;
+        for (auto& shard : shards) {
+            std::lock_guard guard(shard.lock);
+            rows += shard.rows.size();
+        }
+        return rows;
+    }
+};
+
+// splitmix64 finaliser: a bijection, so distinct inputs give distinct keys.
+uint64_t mixKey(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    return x;
+}
+
+// Every thread builds TABLE_ROWS_PER_THREAD rows, each tagged with next_id(group, id), and
+// inserts them into a fresh table. Returns the rows per second, table construction excluded.
+template <typename NextId>
+double measureTableInserts(NextId next_id) {
+    ShardedTable table(NUM_THREADS * TABLE_ROWS_PER_THREAD);
+    std::vector<std::thread> threads;
+    threads.reserve(NUM_THREADS);
+
+    auto start_time = std::chrono::steady_clock::now();
+    for (size_t thread = 0; thread < NUM_THREADS; thread++) {
+        threads.emplace_back([&, thread]() {
+            for (uint64_t i = 0; i < TABLE_ROWS_PER_THREAD; ++i) {
+                TableRecord record;
+                record.key = mixKey(thread * TABLE_ROWS_PER_THREAD + i);
+                for (size_t field = 0; field < record.payload.size(); field++) {
+                    record.payload[field] = record.key + field;
+                }
+                record.id = next_id(thread / NUM_THREADS_PER_COMBINER,
+                                    thread % NUM_THREADS_PER_COMBINER);
+                table.insert(record);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time);
+
+    if (table.size() != NUM_THREADS * TABLE_ROWS_PER_THREAD) {
+        std::cerr << "Table lost rows: " << table.size() << "\n";
+    }
+    return static_cast<double>(NUM_THREADS * TABLE_ROWS_PER_THREAD) / seconds.count();
+}
+
+// End-to-end cost of the id call inside a sharded hash table insert. Thread-local ids need no
+// shared sequencer at all and bound what any sequencer can reach.
+void caseTable() {
+    std::cout << "\n=== Sharded Table Inserts ===\n";
+    std::cout << std::format("{} threads x {} rows of {} bytes, {} shards\n", NUM_THREADS,
+                             TABLE_ROWS_PER_THREAD, sizeof(TableRecord), TABLE_SHARDS);
+    std::cout << "| Implementation | Rows/sec | M rows/sec | Relative to thread-local ids |\n"
+              << "|----------------|----------|------------|------------------------------|\n";
+
+    auto print_line = [](const std::string& name, double rows_per_second, double baseline) {
+        std::cout << std::format("| {} | {:.0f} | {:.2f} | {:.2f} |\n", name, rows_per_second,
+                                 rows_per_second / 1000000, rows_per_second / baseline);
+    };
+    std::vector<uint64_t> local_ids(NUM_THREADS * CACHE_LINE_SIZE / sizeof(uint64_t));
+    double baseline = measureTableInserts([&local_ids](size_t group, size_t my_id) {
+        size_t thread = group * NUM_THREADS_PER_COMBINER + my_id;
+        // one cache line per thread, the thread index in the upper bits keeps ids unique
+        return (uint64_t{thread} << 48) | local_ids[thread * CACHE_LINE_SIZE / sizeof(uint64_t)]++;
+    });
+    print_line("Thread-local ids", baseline, baseline);
+
+    forEachWorkloadSequencer([&print_line, baseline](const std::string& name,
+                                                     auto get_and_increment) {
+        print_line(name, measureTableInserts(get_and_increment), baseline);
+    });
+}
+
+// A cumulative microjoule counter, e.g. one RAPL package domain.
+struct EnergyCounter {
+    std::filesystem::path path;
+    bool package;
+    // the value at which the counter wraps, 0 if unknown
+    uint64_t max_range_uj;
+};
+
+std::optional<uint64_t> readUint64(const std::filesystem::path& path) {
+    std::ifstream stream(path);
+    uint64_t value;
+    if (!(stream >> value)) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+std::string readLine(const std::filesystem::path& path) {
+    std::ifstream stream(path);
+    std::string line;
+    std::getline(stream, line);
+    return line;
+}
+
+// Finds readable package and core energy counters: RAPL zones under /sys/class/powercap (Intel,
+// and AMD on recent kernels) or else the amd_energy hwmon driver. Empty if there are none, e.g.
+// in VMs, on macOS, or because energy_uj is only readable by root. The intel-rapl-mmio zones are
+// skipped: they report the same package domains as the MSR-based intel-rapl zones.
+std::vector<EnergyCounter> detectEnergyCounters() {
+    std::vector<EnergyCounter> counters;
+    std::error_code error;
+    for (const auto& zone : std::filesystem::directory_iterator("/sys/class/powercap", error)) {
+        if (zone.path().filename().string().starts_with("intel-rapl-mmio")) {
+            continue;
+        }
+        std::string name = readLine(zone.path() / "name");
+        bool package = name.starts_with("package");
+        if ((!package && name != "core") || !readUint64(zone.path() / "energy_uj")) {
+            continue;
+        }
+        counters.push_back(EnergyCounter{zone.path() / "energy_uj", package,
+                                         readUint64(zone.path() / "max_energy_range_uj")
+                                             .value_or(0)});
+    }
+    if (!counters.empty()) {
+        return counters;
+    }
+    for (const auto& hwmon : std::filesystem::directory_iterator("/sys/class/hwmon", error)) {
+        if (readLine(hwmon.path() / "name") != "amd_energy") {
+            continue;
+        }
+        for (int i = 1;; i++) {
+            std::string label = readLine(hwmon.path() / std::format("energy{}_label", i));
+            auto input = hwmon.path() / std::format("energy{}_input", i);
+            if (label.empty() || !readUint64(input)) {
+                break;
+            }
+            counters.push_back(EnergyCounter{input, label.starts_with("Esocket"), 0});
+        }
+    }
+    return counters;
+}
+
+const std::vector<EnergyCounter>& energyCounters() {
+    static const std::vector<EnergyCounter> counters = detectEnergyCounters();
+    return counters;
+}
+
+struct EnergyUsage {
+    double package_joules;
+    double core_joules;
+    double seconds;
+};
+
+// Reads all energy counters on construction; stop() returns the energy used since.
+class EnergyMeter {
+    std::vector<uint64_t> start_values;
+    std::chrono::steady_clock::time_point start_time;
+
+   public:
+    EnergyMeter()
+        : start_time(std::chrono::steady_clock::now()) {
+        for (const auto& counter : energyCounters()) {
+            start_values.push_back(readUint64(counter.path).value_or(0));
+        }
+    }
+
+    std::optional<EnergyUsage> stop() const {
+        const auto& counters = energyCounters();
+        if (counters.empty()) {
+            return std::nullopt;
+        }
+        EnergyUsage usage{0, 0,
+                          std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                        start_time)
+                              .count()};
+        for (size_t i = 0; i < counters.size(); i++) {
+            uint64_t end_value = readUint64(counters[i].path).value_or(start_values[i]);
+            uint64_t used_uj = end_value >= start_values[i]
+                                   ? end_value - start_values[i]
+                                   : end_value + counters[i].max_range_uj - start_values[i];
+            (counters[i].package ? usage.package_joules : usage.core_joules) +=
+                static_cast<double>(used_uj) / 1e6;
+        }
+        return usage;
+    }
+};
+
+const std::chrono::milliseconds TIMELINE_INTERVAL{50};
+const std::string TIMELINE_CSV_PATH = "timeline.csv";
+
+// Mean scaling_cur_freq over all cpus in MHz, empty without cpufreq in sysfs.
+std::optional<double> meanCpuFrequencyMhz() {
+    int num_cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    double total_khz = 0;
+    int readable = 0;
+    for (int cpu = 0; cpu < num_cpus; cpu++) {
+        std::string khz = readCpuSysfs(cpu, "cpufreq/scaling_cur_freq");
+        if (!khz.empty()) {
+            total_khz += std::stod(khz);
+            readable++;
+        }
+    }
+    if (readable == 0) {
+        return std::nullopt;
+    }
+    return total_khz / readable / 1000;
+}
+
+struct TimelineSample {
+    std::chrono::duration<double> time;
+    // completed operations in the interval ending at time
+    uint64_t operations;
+    std::optional<double> cpu_mhz;
+};
+
+// Samples completedOperations() and the cpu frequency every TIMELINE_INTERVAL from construction
+// until stop().
+class TimelineSampler {
+    std::vector<TimelineSample> samples;
+    std::atomic<bool> stopped{false};
+    std::thread thread;
+
+   public:
+    TimelineSampler() {
+        thread = std::thread([this]() {
+            auto start_time = std::chrono::steady_clock::now();
+            uint64_t last_operations = completedOperations();
+            for (auto next = start_time + TIMELINE_INTERVAL; !stopped; next += TIMELINE_INTERVAL) {
+                while (!stopped && std::chrono::steady_clock::now() < next) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                uint64_t operations = completedOperations();
+                samples.push_back(TimelineSample{std::chrono::steady_clock::now() - start_time,
+                                                 operations - last_operations,
+                                                 meanCpuFrequencyMhz()});
+                last_operations = operations;
+            }
+        });
+    }
+
+    std::vector<TimelineSample> stop() {
+        stopped = true;
+        thread.join();
+        return samples;
+    }
+};
+
+struct CaseResult {
+    std::string name;
+    std::chrono::milliseconds time;
+    std::optional<EnergyUsage> energy;
+    // CPU time of all threads during the case, and the estimated part of it spent waiting in
+    // pause loops and contended mutex acquisitions, if STATS_ENABLED
+    std::chrono::duration<double> cpu_time;
+    std::optional<std::chrono::duration<double>> wait_time;
+    std::vector<TimelineSample> timeline;
+};
+
+template <typename Case>
+CaseResult runCase(const std::string& name, Case run_case) {
+    std::chrono::duration<double> relax_time = waitRelaxTime();
+    EnergyMeter meter;
+    auto cpu_start = processCpuTime();
+    uint64_t wait_relaxes_start = waitRelaxes();
+    std::chrono::duration<double> lock_wait_start = lockWaitTime();
+    TimelineSampler sampler;
+    std::chrono::milliseconds time = run_case();
+    auto timeline = sampler.stop();
+    std::chrono::duration<double> cpu_time = processCpuTime() - cpu_start;
+    std::optional<std::chrono::duration<double>> wait_time;
+    if (STATS_ENABLED) {
+        wait_time = relax_time * static_cast<double>(waitRelaxes() - wait_relaxes_start) +
+                    (lockWaitTime() - lock_wait_start);
+    }
+    return CaseResult{name, time, meter.stop(), cpu_time, wait_time, timeline};
+}
+
+void printTableHeader() {
+    std::cout << "| Implementation | Duration | Throughput (ops/sec) | Throughput (M ops/sec) | "
+                 "Relative Performance | CPU (s) | M ops/CPU-sec | Spin waste | "
+                 "Package (J/M ops) | Core (J/M ops) | Package (W) |\n"
+              << "|------------|----------|---------------------|------------------|---------------"
+                 "------|---------|---------------|------------|-------------------|"
+                 "----------------|-------------|\n";
+}
+
+void printTableLine(const CaseResult& result, std::chrono::milliseconds min_time) {
+    auto time = result.time;
+    double throughput =
+        (static_cast<double>(TOTAL_OPERATIONS) * 1000.0) / static_cast<double>(time.count());
+    double min_throughput =
+        (static_cast<double>(TOTAL_OPERATIONS) * 1000.0) / static_cast<double>(min_time.count());
+    std::string energy = "n/a | n/a | n/a";
+    if (result.energy) {
+        double million_ops = static_cast<double>(TOTAL_OPERATIONS) / 1000000;
+        const EnergyUsage& usage = *result.energy;
+        energy = std::format("{:.3f} | {:.3f} | {:.1f}", usage.package_joules / million_ops,
+                             usage.core_joules / million_ops,
+                             usage.package_joules / usage.seconds);
+    }
+    double cpu_seconds = result.cpu_time.count();
+    std::string wait = "n/a";
+    if (result.wait_time) {
+        wait = std::format("{:.1f}%",
+                           cpu_seconds > 0 ? result.wait_time->count() / cpu_seconds * 100 : 0);
+    }
+    std::string cpu = std::format(
+        "{:.2f} | {:.2f} | {}", cpu_seconds,
+        cpu_seconds > 0 ? static_cast<double>(TOTAL_OPERATIONS) / cpu_seconds / 1000000 : 0,
+        wait);
+    std::cout << std::format("| {} | {}.{:03} | {} | {} | {:.2f} | {} | {} |\n", result.name,
+                             time.count() / 1000, time.count() % 1000, throughput,
+                             throughput / 1000000, throughput / min_throughput, cpu, energy);
+}
+
+void printTable(const std::vector<CaseResult>& results) {
+    std::chrono::milliseconds min_time = std::min_element(results.begin(), results.end(),
+                                                          [](const auto& a, const auto& b) {
+                                                              return a.time < b.time;
+                                                          })
+                                             ->time;
+    printTableHeader();
+    for (const auto& result : results) {
+        printTableLine(result, min_time);
+    }
+    if (!STATS_ENABLED) {
+        std::cout << "Spin waste: needs a build with -DSEQUENCER_STATS\n";
+    }
+    if (energyCounters().empty()) {
+        std::cout << "Energy: no readable powercap (RAPL) or amd_energy counters\n";
+    }
+}
+
+// Summarises every case's timeline, leaving out the partial last interval, and writes all samples
+// to TIMELINE_CSV_PATH. Differing halves point to warm-up, throttling or a change of regime.
+void printTimelines(const std::vector<CaseResult>& results) {
+    std::cout << "\n=== Throughput Timeline (M ops/sec per " << TIMELINE_INTERVAL.count()
+              << " ms) ===\n";
+    std::cout << "| Implementation | Samples | First | Min | Median | Max | First half | "
+                 "Second half | Mean MHz |\n"
+              << "|----------------|---------|-------|-----|--------|-----|------------|"
+                 "-------------|----------|\n";
+    std::ofstream csv(TIMELINE_CSV_PATH);
+    csv << "case,time_ms,operations,mops,cpu_mhz\n";
+    for (const auto& result : results) {
+        std::vector<double> rates;
+        double total_mhz = 0;
+        size_t mhz_samples = 0;
+        std::chrono::duration<double> previous_time{0};
+        for (const auto& sample : result.timeline) {
+            // the sampler may wake up late, so use the actual interval
+            double seconds = (sample.time - previous_time).count();
+            previous_time = sample.time;
+            double rate = static_cast<double>(sample.operations) / seconds / 1000000;
+            csv << std::format("{},{:.0f},{},{:.3f},{}\n", result.name,
+                               sample.time.count() * 1000, sample.operations, rate,
+                               sample.cpu_mhz ? std::format("{:.0f}", *sample.cpu_mhz) : "");
+            if (&sample != &result.timeline.back()) {
+                rates.push_back(rate);
+            }
+            if (sample.cpu_mhz) {
+                total_mhz += *sample.cpu_mhz;
+                mhz_samples++;
+            }
+        }
+        std::string mhz = mhz_samples == 0 ? "n/a" : std::format("{:.0f}", total_mhz / mhz_samples);
+        if (rates.empty()) {
+            std::cout << std::format("| {} | 0 | n/a | n/a | n/a | n/a | n/a | n/a | {} |\n",
+                                     result.name, mhz);
+            continue;
+        }
+        auto mean = [](auto begin, auto end) {
+            return begin == end ? 0 : std::accumulate(begin, end, 0.0) / (end - begin);
+        };
+        size_t half = rates.size() / 2;
+        double first_half = mean(rates.begin(), rates.begin() + std::max<size_t>(half, 1));
+        double second_half = mean(rates.begin() + half, rates.end());
+        double first = rates.front();
+        std::vector<double> sorted = rates;
+        std::sort(sorted.begin(), sorted.end());
+        std::cout << std::format(
+            "| {} | {} | {:.2f} | {:.2f} | {:.2f} | {:.2f} | {:.2f} | {:.2f} | {} |\n",
+            result.name, rates.size(), first, sorted.front(), sorted[sorted.size() / 2],
+            sorted.back(), first_half, second_half, mhz);
+    }
+    std::cout << "Samples written to " << TIMELINE_CSV_PATH << "\n";
+}
+
+}  // namespace
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [all | tune [config file] | latency | skew | burst [quiet ms] [burst ms] |"
+                 " churn [mean ids >= 1] | heatmap [output prefix] | stats [file | :port] |"
+                 " preempt [probability 0-1] [duration us] [sleep | yield] | table]\n";
+}
+
+int main(int argc, char** argv) {
+    std::string mode = argc > 1 ? argv[1] : "all";
+    // the numeric argument at index, or fallback if there is none; empty if it is malformed
+    auto number_argument = [argc, argv](int index, uint64_t fallback) {
+        return argc > index ? parseUint64(argv[index]) : std::optional<uint64_t>(fallback);
+    };
+    if (mode == "tune") {
+        runTuner(argc > 2 ? argv[2] : TUNING_CONFIG_PATH);
+        return 0;
+    }
+    if (mode == "latency") {
+        caseUncontended();
+        return 0;
+    }
+    if (mode == "skew") {
+        caseSkew();
+        return 0;
+    }
+    if (mode == "burst") {
+        BurstConfig config;
+        auto quiet_ms = number_argument(2, config.quiet_duration.count());
+        auto burst_ms = number_argument(3, config.burst_duration.count());
+        if (!quiet_ms || !burst_ms) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        config.quiet_duration = std::chrono::milliseconds(*quiet_ms);
+        config.burst_duration = std::chrono::milliseconds(*burst_ms);
+        caseBurst(config);
+        return 0;
+    }
+    if (mode == "churn") {
+        std::optional<uint64_t> mean_ids = number_argument(2, CHURN_DEFAULT_MEAN_IDS);
+        if (!mean_ids || *mean_ids < 1) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        caseChurn(*mean_ids);
+        return 0;
+    }
+    if (mode == "heatmap") {
+        caseHeatmap(argc > 2 ? argv[2] : HEATMAP_OUTPUT_PREFIX);
+        return 0;
+    }
+    if (mode == "stats") {
+        if (!STATS_ENABLED) {
+            std::cerr << "Sequencer stats are not compiled in, rebuild with -DSEQUENCER_STATS\n";
+            return 1;
+        }
+        std::string target = argc > 2 ? argv[2] : STATS_DEFAULT_TARGET;
+        if (target.starts_with(':')) {
+            std::optional<uint64_t> port = parseUint64(target.substr(1));
+            if (!port || *port == 0 || *port > 65535) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        caseStats(target);
+        return 0;
+    }
+    if (mode == "preempt") {
+        std::optional<double> probability =
+            argc > 2 ? parseDouble(argv[2]) : PREEMPT_DEFAULT_PROBABILITY;
+        auto duration_us = number_argument(3, PREEMPT_DEFAULT_DURATION.count());
+        std::string wait = argc > 4 ? argv[4] : "sleep";
+        // also rejects NaN
+        if (!probability || !(*probability >= 0 && *probability <= 1) || !duration_us ||
+            (wait != "sleep" && wait != "yield")) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        casePreempt(PreemptionInjection{*probability, std::chrono::microseconds(*duration_us),
+                                        wait == "yield"});
+        return 0;
+    }
+    if (mode == "table") {
+        caseTable();
+        return 0;
+    }
+    if (mode != "all") {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::optional<SequencerConfig> tuned_config = loadSequencerConfig(TUNING_CONFIG_PATH);
+
+    std::vector<CaseResult> results;
+    results.push_back(runCase("Lock", caseLock));
+    results.push_back(runCase("Simple CAS", caseSimple));
+    results.push_back(runCase("Combiner", []() {
+        return caseCombiner<Combiner<NUM_THREADS_PER_COMBINER>>("Combiner", counter_combiner);
+    }));
+    results.push_back(runCase("Multi-Round Combiner", []() {
+        return caseCombiner<
+            MultiRoundCombiner<NUM_THREADS_PER_COMBINER, counter_combiner_multi_round>>(
+            "Multi-Round Combiner", counter_combiner_multi_round);
+    }));
+    results.push_back(runCase("Fair Combiner", []() {
+        return caseCombiner<FairCombiner<NUM_THREADS_PER_COMBINER>>(
+            "Fair Combiner", counter_combiner_fair, FAIR_MAX_CONSECUTIVE_ROUNDS);
+    }));
+    results.push_back(runCase("SNZI Combiner", []() {
+        return caseCombiner<SnziCombiner<NUM_THREADS_PER_COMBINER>>("SNZI Combiner",
+                                                                    counter_combiner_snzi);
+    }));
+    results.push_back(runCase("Stack Combiner", caseStackCombiner));
+    results.push_back(runCase("Delegation", caseDelegation));
+    results.push_back(runCase("Bulk Synchronous", caseBulkSynchronous));
+    if (tuned_config) {
+        std::cout << "\n=== Results Tuned (" << TUNING_CONFIG_PATH << ") ===\n"
+                  << describe(*tuned_config) << "\n";
+        results.push_back(runCase("Tuned " + tuned_config->strategy, [&tuned_config]() {
+            auto duration = measureConfig(*tuned_config, COUNT_PER_THREAD).duration;
+            applySequencerConfig(SequencerConfig{});
+            return std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+        }));
+    }
+
+    printTable(results);
+    printTimelines(results);
+
+    caseCombinerFairness<Combiner<NUM_THREADS_PER_COMBINER>>("Combiner");
+    caseCombinerFairness<
+        MultiRoundCombiner<NUM_THREADS_PER_COMBINER, counter_combiner_multi_round>>(
+        "Multi-Round Combiner");
+    caseCombinerFairness<FairCombiner<NUM_THREADS_PER_COMBINER>>("Fair Combiner",
+                                                                 FAIR_MAX_CONSECUTIVE_ROUNDS);
+
+    casePriority();
+
+    caseTryNext(std::format("{} cycles", TRY_BUDGET_CYCLES),
+                []() { return deadlineAfterCycles(TRY_BUDGET_CYCLES); });
+    caseTryNext(std::format("{} ns", TRY_BUDGET_TIME.count()),
+                []() { return deadlineAfter(TRY_BUDGET_TIME); });
+
+    caseStatisticalCounter();
+
+    caseRelaxed();
+
+    caseEpoch();
+
+    caseSnapshot();
 
     return 0;
 }